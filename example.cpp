@@ -33,20 +33,14 @@ int main() {
     dddf[i] = -df[i]; // -cos
   }
 
-  // compute the numerical first derivative
-  nb_points = 8;
-  diff_order = 1;
-  fp = fd(diff_order + 1, nb_points, xgrid, f);
-
-  // compute the numerical second derivative
-  nb_points = 8;
-  diff_order = 2;
-  fpp = fd(diff_order + 1, nb_points, xgrid, f);
-
-  // compute the numerical third derivative
+  // compute the numerical first, second and third derivatives
+  // (all orders come from one pass over the grid)
   nb_points = 8;
   diff_order = 3;
-  fppp = fd(diff_order + 1, nb_points, xgrid, f);
+  vector<vector<double> > dfs = fd_all(diff_order + 1, nb_points, xgrid, f);
+  fp = dfs[1];
+  fpp = dfs[2];
+  fppp = dfs[3];
 
   // compare exact and numerical values
   double diff1(0.0), diff2(0.0), diff3(0.0);
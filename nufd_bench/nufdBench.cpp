@@ -0,0 +1,192 @@
+#include "benchmark/benchmark.h"
+#include "fdplan.h"
+#include "fdcompact.h"
+
+// performance suite of fdcoef, fd and FdPlan
+//
+// every benchmark reports ns/point and bytes/point (the memory traffic of
+// one grid point). results are saved as json with
+//   nufd_bench --benchmark_out=nufd.json --benchmark_out_format=json
+// and hardware counters are added, when google benchmark is built with
+// libpfm, with --benchmark_perf_counters=CYCLES,INSTRUCTIONS,CACHE-MISSES
+// (only the last grid is kept, 1.6 GB at 10^8 points, but BM_plan_apply
+// at 10^8 points with n = 9 also builds 8 GB of weights and offsets, use
+// --benchmark_filter to select smaller runs)
+
+// grid and function values of ngrid points, uniform or random spacing
+struct BenchGrid {
+  vector<double> x, u;
+};
+
+static const BenchGrid &bench_grid(size_t ngrid, bool uniform) {
+  // the grid of the previous benchmark is freed when another one is needed
+  static pair<size_t, bool> key(0, false);
+  static BenchGrid g;
+  if (g.x.empty() || key != make_pair(ngrid, uniform)) {
+    key = make_pair(ngrid, uniform);
+    vector<double>().swap(g.x);
+    vector<double>().swap(g.u);
+    g.x.resize(ngrid, 0.0);
+    g.u.resize(ngrid, 0.0);
+    std::mt19937_64 rng(1988);
+    uniform_real_distribution<double> unif(0.5, 1.5);
+    double h(1.0 / double(ngrid));
+    for (size_t i(1); i < ngrid; i++)
+      g.x[i] = uniform ? double(i) * h : g.x[i - 1] + h * unif(rng);
+    for (size_t i(0); i < ngrid; i++)
+      g.u[i] = sin(10.0 * g.x[i]);
+  }
+  return g;
+}
+
+// wall time of the timed loop of a benchmark
+typedef chrono::steady_clock::time_point BenchStart;
+
+static BenchStart bench_start() { return chrono::steady_clock::now(); }
+
+static void set_counters(benchmark::State &state, BenchStart start, size_t points, double bytes) {
+  double ns(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+  state.SetItemsProcessed(int64_t(state.iterations() * points));
+  state.SetBytesProcessed(int64_t(state.iterations() * points * bytes));
+  // plain value (rate counters are printed in seconds)
+  state.counters["ns/point"] = ns / (double(state.iterations()) * double(points));
+  state.counters["bytes/point"] = bytes;
+}
+
+// args: stencil width n, derivative m (1=value, 2=1st diff, ...)
+static void fdcoef_args(benchmark::internal::Benchmark *b) {
+  for (int n : {3, 5, 9, 17, 33})
+    for (int m : {2, 3, 5})
+      if (m <= n)
+        b->Args({n, m});
+}
+
+// args: grid size, uniform grid, stencil width n, derivative m
+static void grid_args(benchmark::internal::Benchmark *b) {
+  for (int64_t ngrid(100); ngrid <= 100000000; ngrid *= 10)
+    for (int uniform : {0, 1})
+      for (int n : {5, 9})
+        b->Args({ngrid, uniform, n, 2});
+}
+
+static void BM_fdcoef(benchmark::State &state) {
+  unsigned int n(state.range(0)), m(state.range(1));
+  const BenchGrid &g(bench_grid(n, false));
+  vector<double> coef(n);
+  vector<long double> work(fdcoef_worksize(m, n));
+  BenchStart start(bench_start());
+  for (auto _ : state) {
+    fdcoef(m, n, g.x[n / 2], g.x.data(), coef.data(), work.data());
+    benchmark::DoNotOptimize(coef.data());
+  }
+  // one call computes the weights of one point
+  set_counters(state, start, 1, double(n) * sizeof(double) * 2.0);
+}
+BENCHMARK(BM_fdcoef)->Apply(fdcoef_args);
+
+static void BM_fdcoef_dd(benchmark::State &state) {
+  unsigned int n(state.range(0)), m(state.range(1));
+  const BenchGrid &g(bench_grid(n, false));
+  vector<double> coef(n);
+  vector<double> work(fdcoef_dd_worksize(m, n));
+  BenchStart start(bench_start());
+  for (auto _ : state) {
+    fdcoef_dd(m, n, g.x[n / 2], g.x.data(), coef.data(), work.data());
+    benchmark::DoNotOptimize(coef.data());
+  }
+  set_counters(state, start, 1, double(n) * sizeof(double) * 2.0);
+}
+BENCHMARK(BM_fdcoef_dd)->Apply(fdcoef_args);
+
+static void BM_fdcoef_vector(benchmark::State &state) {
+  unsigned int n(state.range(0)), m(state.range(1));
+  const BenchGrid &g(bench_grid(n, false));
+  BenchStart start(bench_start());
+  for (auto _ : state) {
+    vector<double> coef = fdcoef(m, n, g.x[n / 2], g.x.begin());
+    benchmark::DoNotOptimize(coef.data());
+  }
+  set_counters(state, start, 1, double(n) * sizeof(double) * 2.0);
+}
+BENCHMARK(BM_fdcoef_vector)->Apply(fdcoef_args);
+
+static void BM_fd(benchmark::State &state) {
+  size_t ngrid(state.range(0));
+  unsigned int n(state.range(2)), m(state.range(3));
+  const BenchGrid &g(bench_grid(ngrid, state.range(1) != 0));
+  BenchStart start(bench_start());
+  for (auto _ : state) {
+    vector<double> du = fd(m, n, g.x, g.u);
+    benchmark::DoNotOptimize(du.data());
+  }
+  // grid, function and derivative values
+  set_counters(state, start, ngrid, 3.0 * sizeof(double));
+}
+BENCHMARK(BM_fd)->Apply(grid_args)->Unit(benchmark::kMillisecond);
+
+static void BM_fd_threads(benchmark::State &state) {
+  size_t ngrid(state.range(0));
+  unsigned int n(state.range(2)), m(state.range(3));
+  const BenchGrid &g(bench_grid(ngrid, state.range(1) != 0));
+  BenchStart start(bench_start());
+  for (auto _ : state) {
+    vector<double> du = fd(m, n, g.x, g.u, 0);
+    benchmark::DoNotOptimize(du.data());
+  }
+  set_counters(state, start, ngrid, 3.0 * sizeof(double));
+}
+BENCHMARK(BM_fd_threads)->Apply(grid_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_plan_apply(benchmark::State &state) {
+  size_t ngrid(state.range(0));
+  unsigned int n(state.range(2)), m(state.range(3));
+  const BenchGrid &g(bench_grid(ngrid, state.range(1) != 0));
+  FdPlan plan(m, n, g.x);
+  vector<double> du(ngrid);
+  BenchStart start(bench_start());
+  for (auto _ : state) {
+    plan.apply(g.u.data(), du.data());
+    benchmark::DoNotOptimize(du.data());
+  }
+  // weights, stencil offset, function and derivative values
+  set_counters(state, start, ngrid, double(n) * sizeof(double) + sizeof(size_t) + 2.0 * sizeof(double));
+}
+BENCHMARK(BM_plan_apply)->Apply(grid_args)->Unit(benchmark::kMillisecond);
+
+// extra arg: format of the weights (0 = float, 1 = delta)
+static void BM_compact_apply(benchmark::State &state) {
+  size_t ngrid(state.range(0));
+  unsigned int n(state.range(2)), m(state.range(3));
+  const BenchGrid &g(bench_grid(ngrid, state.range(1) != 0));
+  FdCompactPlan plan(FdPlan(m, n, g.x), state.range(4) ? FDCOMPACT_DELTA : FDCOMPACT_FLOAT);
+  vector<double> du(ngrid);
+  BenchStart start(bench_start());
+  for (auto _ : state) {
+    plan.apply(g.u.data(), du.data());
+    benchmark::DoNotOptimize(du.data());
+  }
+  // compact weights, function and derivative values
+  set_counters(state, start, ngrid, plan.bytes() + 2.0 * sizeof(double));
+}
+BENCHMARK(BM_compact_apply)->Apply([](benchmark::internal::Benchmark *b) {
+  for (int64_t ngrid(100); ngrid <= 100000000; ngrid *= 10)
+    for (int n : {5, 9})
+      for (int format : {0, 1})
+        b->Args({ngrid, 0, n, 2, format});
+})->Unit(benchmark::kMillisecond);
+
+static void BM_fd_integral(benchmark::State &state) {
+  size_t ngrid(state.range(0));
+  unsigned int n(state.range(2));
+  const BenchGrid &g(bench_grid(ngrid, state.range(1) != 0));
+  BenchStart start(bench_start());
+  for (auto _ : state) {
+    vector<double> iu = fd_integral(n, g.x, g.u, 0);
+    benchmark::DoNotOptimize(iu.data());
+  }
+  // grid, function and integral values
+  set_counters(state, start, ngrid, 3.0 * sizeof(double));
+}
+BENCHMARK(BM_fd_integral)->Apply(grid_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,241 @@
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "nufd.h"
+
+// command line tool to differentiate large binary files
+//
+// nufd_cli [-n points] [-d orders] grid.bin field.bin output.bin
+//
+// grid.bin and field.bin contain ngrid doubles (raw, native byte order),
+// output.bin receives one column of ngrid doubles per requested order
+// (-d 1,2,3 writes the 1st, 2nd and 3rd derivatives one after the other,
+// 0 is the interpolated value). the files are memory-mapped: the derivatives
+// are computed directly from the input pages into the output pages, block by
+// block, while the kernel reads ahead the next input block and writes back
+// the previous output block.
+
+// number of grid points per block
+#define CLI_BLOCK (1 << 16)
+
+static void usage() {
+  cerr << "usage: nufd_cli [-n points] [-d orders] grid.bin field.bin output.bin" << endl;
+  cerr << "  -n points  number of points of the finite difference schemes (default 5)" << endl;
+  cerr << "  -d orders  comma separated derivative orders (default 1)" << endl;
+}
+
+// non-negative integer argument, false if text is not one
+static bool parse_uint(const char *text, unsigned int &value) {
+  char *end;
+  errno = 0;
+  long v(strtol(text, &end, 10));
+  if (end == text || *end != '\0' || errno == ERANGE || v < 0 || v > long(UINT_MAX))
+    return false;
+  value = (unsigned int) v;
+  return true;
+}
+
+// map a whole input file read-only, returns the number of doubles
+// and the status of the file (st)
+static const double *map_input(const char *name, size_t &count, struct stat &st) {
+  int fd(open(name, O_RDONLY));
+  if (fd < 0) {
+    cerr << "nufd_cli: cannot open " << name << ": " << strerror(errno) << endl;
+    return nullptr;
+  }
+
+  if (fstat(fd, &st) != 0) {
+    cerr << "nufd_cli: cannot stat " << name << ": " << strerror(errno) << endl;
+    close(fd);
+    return nullptr;
+  }
+  count = size_t(st.st_size) / sizeof(double);
+  if (size_t(st.st_size) % sizeof(double) != 0) {
+    cerr << "nufd_cli: the size of " << name << " is not a multiple of " << sizeof(double) << " bytes" << endl;
+    close(fd);
+    return nullptr;
+  }
+  if (count == 0) {
+    cerr << "nufd_cli: " << name << " is empty" << endl;
+    close(fd);
+    return nullptr;
+  }
+
+  void *data(mmap(nullptr, count * sizeof(double), PROT_READ, MAP_SHARED, fd, 0));
+  close(fd);
+  if (data == MAP_FAILED) {
+    cerr << "nufd_cli: cannot map " << name << ": " << strerror(errno) << endl;
+    return nullptr;
+  }
+  madvise(data, count * sizeof(double), MADV_SEQUENTIAL);
+  return (const double *) data;
+}
+
+// create and map the output file
+static double *map_output(const char *name, size_t count) {
+  int fd(open(name, O_RDWR | O_CREAT | O_TRUNC, 0644));
+  if (fd < 0) {
+    cerr << "nufd_cli: cannot create " << name << ": " << strerror(errno) << endl;
+    return nullptr;
+  }
+
+  if (ftruncate(fd, off_t(count * sizeof(double))) != 0) {
+    cerr << "nufd_cli: cannot resize " << name << ": " << strerror(errno) << endl;
+    close(fd);
+    return nullptr;
+  }
+
+  void *data(mmap(nullptr, count * sizeof(double), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+  close(fd);
+  if (data == MAP_FAILED) {
+    cerr << "nufd_cli: cannot map " << name << ": " << strerror(errno) << endl;
+    return nullptr;
+  }
+  return (double *) data;
+}
+
+// page aligned advice on the range [begin, end) of an array of doubles
+static void advise(const double *data, size_t begin, size_t end, int advice) {
+  size_t page(sysconf(_SC_PAGESIZE));
+  uintptr_t b((uintptr_t) (data + begin) / page * page);
+  uintptr_t e((uintptr_t) (data + end));
+  if (e > b)
+    madvise((void *) b, e - b, advice);
+}
+
+static void flush(double *data, size_t begin, size_t end) {
+  size_t page(sysconf(_SC_PAGESIZE));
+  uintptr_t b((uintptr_t) (data + begin) / page * page);
+  uintptr_t e((uintptr_t) (data + end));
+  if (e > b)
+    msync((void *) b, e - b, MS_ASYNC);
+}
+
+int main(int argc, char **argv) {
+  unsigned int n(5);
+  vector<unsigned int> orders;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:d:h")) != -1) {
+    switch (opt) {
+      case 'n':
+        if (!parse_uint(optarg, n) || n == 0) {
+          cerr << "nufd_cli: invalid number of points " << optarg << endl;
+          return 1;
+        }
+        break;
+      case 'd': {
+        // every comma separated entry must be an order (no empty entry)
+        char *token(optarg);
+        while (true) {
+          char *comma(strchr(token, ','));
+          if (comma)
+            *comma = '\0';
+          unsigned int order;
+          if (!parse_uint(token, order)) {
+            cerr << "nufd_cli: invalid derivative order '" << token << "'" << endl;
+            return 1;
+          }
+          orders.push_back(order);
+          if (!comma)
+            break;
+          token = comma + 1;
+        }
+        break;
+      }
+      default:
+        usage();
+        return 1;
+    }
+  }
+  if (argc - optind != 3) {
+    usage();
+    return 1;
+  }
+  if (orders.empty())
+    orders.push_back(1);
+
+  // all the orders come from the same recursion
+  unsigned int dmax(*max_element(orders.begin(), orders.end()));
+  if (dmax >= n) {
+    cerr << "nufd_cli: " << n << " points are not enough for a derivative of order " << dmax << endl;
+    return 1;
+  }
+  unsigned int mord(dmax + 1);
+
+  size_t ngrid, nfield;
+  struct stat gst, ust, ost;
+  const double *grid(map_input(argv[optind], ngrid, gst));
+  const double *u(map_input(argv[optind + 1], nfield, ust));
+  if (!grid || !u)
+    return 1;
+
+  // the output is truncated before being written: it cannot be an input
+  if (stat(argv[optind + 2], &ost) == 0 &&
+      ((ost.st_dev == gst.st_dev && ost.st_ino == gst.st_ino) ||
+       (ost.st_dev == ust.st_dev && ost.st_ino == ust.st_ino))) {
+    cerr << "nufd_cli: the output " << argv[optind + 2] << " is one of the input files" << endl;
+    return 1;
+  }
+  if (ngrid != nfield) {
+    cerr << "nufd_cli: the grid has " << ngrid << " points and the field " << nfield << endl;
+    return 1;
+  }
+  if (ngrid < n) {
+    cerr << "nufd_cli: the grid has less than " << n << " points" << endl;
+    return 1;
+  }
+
+  size_t nout(orders.size());
+  double *du(map_output(argv[optind + 2], nout * ngrid));
+  if (!du)
+    return 1;
+
+  vector<double> coef(mord * n, 0.0);
+  vector<long double> work(fdcoef_worksize(mord, n));
+  size_t fb((n - 1) / 2);
+  size_t released(0);
+
+  for (size_t begin(0); begin < ngrid; begin += CLI_BLOCK) {
+    size_t end(min(begin + CLI_BLOCK, ngrid));
+
+    // read ahead the next block
+    if (end < ngrid) {
+      size_t next(min(end + CLI_BLOCK, ngrid));
+      advise(grid, end, next, MADV_WILLNEED);
+      advise(u, end, next, MADV_WILLNEED);
+    }
+
+    for (size_t i(begin); i < end; i++) {
+      size_t start(fdstart(i, n, ngrid));
+      fdcoef_all(mord, n, grid[i], grid + start, coef.data(), work.data());
+      for (size_t k(0); k < nout; k++) {
+        const double *w(&coef[orders[k] * n]);
+        double sum(0.0);
+        for (int j(0); j < n; j++)
+          sum = sum + w[j] * u[start + j];
+        du[k * ngrid + i] = sum;
+      }
+    }
+
+    // write back the block and release the input pages that
+    // the next stencils do not use anymore (since the last block)
+    for (size_t k(0); k < nout; k++)
+      flush(du + k * ngrid, begin, end);
+    if (end > fb + n && end - fb - n > released) {
+      advise(grid, released, end - fb - n, MADV_DONTNEED);
+      advise(u, released, end - fb - n, MADV_DONTNEED);
+      released = end - fb - n;
+    }
+  }
+
+  munmap((void *) grid, ngrid * sizeof(double));
+  munmap((void *) u, ngrid * sizeof(double));
+  munmap(du, nout * ngrid * sizeof(double));
+  return 0;
+}
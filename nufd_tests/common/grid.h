@@ -0,0 +1,31 @@
+#ifndef _grid_
+#define _grid_
+
+#include "nufd.h"
+
+// grids shared by the test cases
+
+// non-uniform grid[ngrid] starting at 0, the spacings are
+// h + unif(0, jitter) drawn with a fixed seed
+inline vector<double> random_grid(size_t ngrid, unsigned int seed, double h, double jitter) {
+  vector<double> x(ngrid, 0.0);
+  std::mt19937_64 rng(seed);
+  uniform_real_distribution<double> unif(0, jitter);
+  for (size_t i(1); i < ngrid; i++)
+    x[i] = x[i - 1] + h + unif(rng);
+  return x;
+}
+
+// grid[ngrid] on [0, 1], the interior points of the uniform grid of
+// spacing h are moved by unif(-jitter, jitter) * h with a fixed seed
+inline vector<double> perturbed_grid(size_t ngrid, unsigned int seed, double jitter) {
+  vector<double> x(ngrid);
+  std::mt19937_64 rng(seed);
+  uniform_real_distribution<double> unif(-jitter, jitter);
+  double h(1.0 / double(ngrid - 1));
+  for (size_t i(0); i < ngrid; i++)
+    x[i] = (double(i) + ((i == 0 || i == ngrid - 1) ? 0.0 : unif(rng))) * h;
+  return x;
+}
+
+#endif //_grid_
@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+#include "fdplan.h"
+#include "fddomain.h"
+#include "grid.h"
+
+class fdDomain: public ::testing::Test {
+ protected:
+
+  // fixture used in all test cases
+  virtual void SetUp() {
+    ngrid = 1000;
+    f.resize(ngrid);
+
+    // non-uniform grid with a fixed seed
+    xgrid = random_grid(ngrid, 17, 0.005, 0.01);
+
+    for (int i(0); i < ngrid; i++)
+      f[i] = sin(xgrid[i]);
+  }
+  virtual void TearDown() {}
+
+  unsigned int ngrid;
+  vector<double> xgrid;
+  vector<double> f;
+};
+
+TEST_F(fdDomain, Partition) {
+  vector<size_t> first = fd_partition(10, 3);
+  ASSERT_EQ(first.size(), 4);
+  EXPECT_EQ(first[0], 0);
+  EXPECT_EQ(first[1], 4);
+  EXPECT_EQ(first[2], 7);
+  EXPECT_EQ(first[3], 10);
+}
+
+TEST_F(fdDomain, SameAsPlan) {
+  int parts[] = {1, 2, 3, 7, 16};
+  for (unsigned int n(2); n < 10; n++) {
+    vector<double> expected = FdPlan(2, n, xgrid).apply(f);
+    for (int p : parts) {
+      vector<double> du = fd_domains(2, n, xgrid, f, p);
+      ASSERT_EQ(du.size(), ngrid);
+      for (int i(0); i < ngrid; i++)
+        EXPECT_EQ(du[i], expected[i]) << "n = " << n << ", parts = " << p << ", i = " << i;
+    }
+  }
+}
+
+TEST_F(fdDomain, Ghosts) {
+  // 4 ranks, the ends of the global grid have no ghost
+  FdLocalExchange exchange(4);
+  vector<size_t> first = fd_partition(ngrid, 4);
+  vector<size_t> gl(4), gr(4);
+  vector<thread> workers;
+  for (int r(0); r < 4; r++)
+    workers.push_back(thread([&, r] {
+      FdLocalTransport transport(exchange, r);
+      FdDomain domain(3, 6, vector<double>(xgrid.begin() + first[r], xgrid.begin() + first[r + 1]), transport);
+      gl[r] = domain.ghosts_left();
+      gr[r] = domain.ghosts_right();
+    }));
+  for (size_t t(0); t < workers.size(); t++)
+    workers[t].join();
+
+  EXPECT_EQ(gl[0], 0);
+  EXPECT_EQ(gr[3], 0);
+  for (int r(1); r < 4; r++)
+    EXPECT_EQ(gl[r], 2);
+  for (int r(0); r < 3; r++)
+    EXPECT_EQ(gr[r], 3);
+}
+
+TEST_F(fdDomain, Fields) {
+  // rows of a 2d array split along the first axis, each rank
+  // applies its domain to several fields and several times
+  size_t nfields(5);
+  vector<double> u(ngrid * nfields);
+  for (int i(0); i < ngrid; i++)
+    for (size_t k(0); k < nfields; k++)
+      u[i * nfields + k] = cos((k + 1) * xgrid[i]);
+
+  FdPlan plan(2, 7, xgrid);
+  vector<double> expected = plan.apply(u, nfields);
+
+  int nparts(3);
+  FdLocalExchange exchange(nparts);
+  vector<size_t> first = fd_partition(ngrid, nparts);
+  vector<double> du(ngrid * nfields, 0.0);
+  vector<thread> workers;
+  for (int r(0); r < nparts; r++)
+    workers.push_back(thread([&, r] {
+      FdLocalTransport transport(exchange, r);
+      FdDomain domain(2, 7, vector<double>(xgrid.begin() + first[r], xgrid.begin() + first[r + 1]), transport);
+      for (int repeat(0); repeat < 3; repeat++)
+        domain.apply(&u[first[r] * nfields], &du[first[r] * nfields], nfields);
+    }));
+  for (size_t t(0); t < workers.size(); t++)
+    workers[t].join();
+
+  for (size_t i(0); i < ngrid * nfields; i++)
+    EXPECT_EQ(du[i], expected[i]) << "i = " << i;
+}
+
+TEST_F(fdDomain, SameAsFd) {
+  vector<double> expected = fd(2, 5, xgrid, f);
+  vector<double> du = fd_domains(2, 5, xgrid, f, 8);
+  for (int i(0); i < ngrid; i++)
+    EXPECT_NEAR(du[i], expected[i], 1e-12) << "i = " << i;
+}
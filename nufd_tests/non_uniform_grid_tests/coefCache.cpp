@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+#include "fdcache.h"
+#include "fdplan.h"
+
+// piecewise uniform grid followed by a geometrically stretched region
+static vector<double> stretched_grid() {
+  vector<double> x(1, 0.0);
+  for (int i(0); i < 200; i++)
+    x.push_back(x.back() + 0.01);
+  for (int i(0); i < 200; i++)
+    x.push_back(x.back() + 0.02);
+  double h(0.02);
+  for (int i(0); i < 200; i++) {
+    h = h * 1.01;
+    x.push_back(x.back() + h);
+  }
+  return x;
+}
+
+TEST(coefCache, StretchedGrid) {
+  vector<double> x(stretched_grid()), f(x.size());
+  for (size_t i(0); i < x.size(); i++)
+    f[i] = sin(x[i]);
+
+  for (unsigned int m(2); m <= 3; m++) {
+    FdCoefCache cache(m, 5);
+    vector<double> du = fd(m, 5, x, f, cache);
+    vector<double> ref = fd(m, 5, x, f);
+
+    // a few dozen recursions instead of one per point
+    EXPECT_EQ(cache.hits() + cache.misses(), x.size());
+    EXPECT_EQ(cache.size(), cache.misses());
+    EXPECT_LT(cache.misses(), 20u);
+
+    for (size_t i(0); i < x.size(); i++)
+      EXPECT_NEAR(du[i], ref[i], 1e-9 * (1.0 + fabs(ref[i]))) << "m = " << m << ", i = " << i;
+  }
+}
+
+TEST(coefCache, SharedWithPlan) {
+  vector<double> x(stretched_grid()), f(x.size());
+  for (size_t i(0); i < x.size(); i++)
+    f[i] = exp(-x[i]);
+
+  // second use of the cache only hits
+  FdCoefCache cache(2, 7);
+  vector<double> du = fd(2, 7, x, f, cache);
+  size_t misses(cache.misses());
+  FdPlan plan(2, 7, x, cache);
+  EXPECT_EQ(cache.misses(), misses);
+
+  vector<double> dp = plan.apply(f);
+  for (size_t i(0); i < x.size(); i++)
+    EXPECT_NEAR(dp[i], du[i], 1e-12);
+
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0u);
+  EXPECT_EQ(cache.hits(), 0u);
+}
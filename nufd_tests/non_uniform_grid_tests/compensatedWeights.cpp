@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+#include "nufd.h"
+#include "grid.h"
+
+// maximum error of the order m derivatives of sin(x) on [0, 1] with the
+// double-double weights, ngrid points randomly perturbed by 30% of h
+static double max_error_dd(unsigned int m, unsigned int n, size_t ngrid) {
+  vector<double> x(perturbed_grid(ngrid, 1988, 0.3)), f(ngrid);
+  for (size_t i(0); i < ngrid; i++)
+    f[i] = sin(x[i]);
+
+  vector<double> coef(n), work(fdcoef_dd_worksize(m, n));
+  double err(0.0);
+  for (size_t i(0); i < ngrid; i++) {
+    size_t start(fdstart(i, n, ngrid));
+    fdcoef_dd(m, n, x[i], &x[start], coef.data(), work.data());
+    double du(0.0);
+    for (unsigned int j(0); j < n; j++)
+      du = du + coef[j] * f[start + j];
+    double exact(m == 2 ? cos(x[i]) : -sin(x[i]));
+    err = max(err, fabs(du - exact));
+  }
+  return err;
+}
+
+// the order of accuracy n - (m - 1) is recovered on random grids
+TEST(compensatedWeights, RandomGridConvergence) {
+  for (unsigned int m(2); m <= 3; m++) {
+    for (unsigned int n(m + 2); n <= 7; n++) {
+      double e1(max_error_dd(m, n, 41)), e2(max_error_dd(m, n, 81));
+      double rate(log2(e1 / e2));
+      EXPECT_GT(rate, double(n - m + 1) - 0.6) << "m = " << m << ", n = " << n;
+    }
+  }
+}
+
+// same weights as the long double recursion on random stencils
+TEST(compensatedWeights, SameAsLongDouble) {
+  std::mt19937_64 rng(2016);
+  uniform_real_distribution<double> unif(0.5, 1.5);
+  for (unsigned int n(2); n <= 12; n++) {
+    for (unsigned int m(1); m <= min(n, 5u); m++) {
+      vector<double> x(n, 1.0);
+      for (unsigned int j(1); j < n; j++)
+        x[j] = x[j - 1] + 0.01 * unif(rng);
+
+      vector<double> a(m * n), b(m * n), wd(fdcoef_dd_worksize(m, n));
+      vector<long double> w(fdcoef_worksize(m, n));
+      fdcoef_all(m, n, x[n / 3], x.data(), a.data(), w.data());
+      fdcoef_all_dd(m, n, x[n / 3], x.data(), b.data(), wd.data());
+      for (unsigned int k(0); k < m; k++) {
+        double scale(0.0);
+        for (unsigned int j(0); j < n; j++)
+          scale = max(scale, fabs(a[k * n + j]));
+        for (unsigned int j(0); j < n; j++)
+          EXPECT_NEAR(a[k * n + j], b[k * n + j], 1e-14 * scale) << "m = " << m << ", n = " << n;
+      }
+    }
+  }
+}
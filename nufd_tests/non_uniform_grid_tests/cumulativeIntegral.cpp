@@ -0,0 +1,71 @@
+#include "gtest/gtest.h"
+#include "nufd.h"
+#include "grid.h"
+
+// maximum error of the running integral of cos(x) on [0, 1], ngrid
+// points randomly perturbed by 30% of h
+static double max_error(unsigned int n, size_t ngrid) {
+  vector<double> x(perturbed_grid(ngrid, 51, 0.3)), f(ngrid);
+  for (size_t i(0); i < ngrid; i++)
+    f[i] = cos(x[i]);
+
+  vector<double> iu = fd_integral(n, x, f);
+  double err(0.0);
+  for (size_t i(0); i < ngrid; i++)
+    err = max(err, fabs(iu[i] - sin(x[i])));
+  return err;
+}
+
+// two points give the trapezoidal rule
+TEST(cumulativeIntegral, Trapezoidal) {
+  vector<double> x(perturbed_grid(100, 51, 0.3)), f(100);
+  for (size_t i(0); i < 100; i++)
+    f[i] = exp(x[i]);
+
+  vector<double> iu = fd_integral(2, x, f);
+  double sum(0.0);
+  EXPECT_EQ(iu[0], 0.0);
+  for (size_t i(1); i < 100; i++) {
+    sum = sum + 0.5 * (x[i] - x[i - 1]) * (f[i] + f[i - 1]);
+    EXPECT_NEAR(iu[i], sum, 1e-15) << "i = " << i;
+  }
+}
+
+// polynomials of degree n-1 are integrated exactly
+TEST(cumulativeIntegral, Polynomials) {
+  vector<double> x(perturbed_grid(50, 51, 0.3));
+  for (unsigned int n(2); n < 9; n++) {
+    vector<double> f(x.size());
+    for (size_t i(0); i < x.size(); i++)
+      f[i] = pow(x[i], n - 1);
+
+    vector<double> iu = fd_integral(n, x, f);
+    for (size_t i(0); i < x.size(); i++)
+      EXPECT_NEAR(iu[i], pow(x[i], n) / double(n), 1e-14) << "n = " << n << ", i = " << i;
+  }
+}
+
+// the global order of accuracy n is recovered on random grids
+TEST(cumulativeIntegral, RandomGridConvergence) {
+  for (unsigned int n(2); n <= 6; n++) {
+    double e1(max_error(n, 41)), e2(max_error(n, 81));
+    double rate(log2(e1 / e2));
+    EXPECT_GT(rate, double(n) - 0.6) << "n = " << n;
+  }
+}
+
+// the parallel prefix sum gives the serial values up to rounding
+TEST(cumulativeIntegral, Threads) {
+  vector<double> x(perturbed_grid(10001, 51, 0.3)), f(10001);
+  for (size_t i(0); i < x.size(); i++)
+    f[i] = cos(10.0 * x[i]);
+
+  vector<double> serial = fd_integral(5, x, f);
+  unsigned int threads[] = {2, 3, 7, 16};
+  for (unsigned int t : threads) {
+    vector<double> iu = fd_integral(5, x, f, t);
+    ASSERT_EQ(iu.size(), x.size());
+    for (size_t i(0); i < x.size(); i++)
+      EXPECT_NEAR(iu[i], serial[i], 1e-14) << "threads = " << t << ", i = " << i;
+  }
+}
@@ -0,0 +1,264 @@
+#include "gtest/gtest.h"
+#include "nufd.h"
+#include "fdfixed.h"
+#include "fdstats.h"
+#include "grid.h"
+
+class nonUniformGrid: public ::testing::Test {
+ protected:
+
+  // fixture used in all test cases
+  virtual void SetUp() {
+    ngrid = 60;
+    f.resize(ngrid);
+
+    // non-uniform grid with a fixed seed
+    xgrid = random_grid(ngrid, 2016, 0.02, 0.05);
+
+    for (int i(0); i < ngrid; i++)
+      f[i] = sin(xgrid[i]);
+  }
+  virtual void TearDown() {}
+
+  unsigned int ngrid;
+  vector<double> xgrid;
+  vector<double> f;
+};
+
+// every row of fdcoef_all is the fdcoef of the same order
+TEST_F(nonUniformGrid, AllOrdersCoefficients) {
+  unsigned int nb_points(7);
+  vector<double> all = fdcoef_all(5, nb_points, xgrid[3], xgrid.begin());
+  ASSERT_EQ(all.size(), 5 * nb_points);
+  for (unsigned int m(1); m < 6; m++) {
+    vector<double> coef = fdcoef(m, nb_points, xgrid[3], xgrid.begin());
+    for (int j(0); j < nb_points; j++)
+      EXPECT_DOUBLE_EQ(all[(m - 1) * nb_points + j], coef[j]);
+  }
+}
+
+// fd_all returns the same values as one fd() call per order
+TEST_F(nonUniformGrid, AllOrdersDerivatives) {
+  unsigned int nb_points(8);
+  vector<vector<double> > du = fd_all(4, nb_points, xgrid, f);
+  ASSERT_EQ(du.size(), 4);
+  for (unsigned int m(1); m < 5; m++) {
+    vector<double> dm = fd(m, nb_points, xgrid, f);
+    ASSERT_EQ(du[m - 1].size(), ngrid);
+    for (int i(0); i < ngrid; i++)
+      EXPECT_NEAR(du[m - 1][i], dm[i], 1e-12 * (1.0 + fabs(dm[i]))) << "m = " << m << ", i = " << i;
+  }
+}
+
+// the allocation free version gives the same coefficients
+TEST_F(nonUniformGrid, WorkspaceCoefficients) {
+  unsigned int nb_points(9);
+  vector<double> coef(nb_points);
+  vector<long double> work(fdcoef_worksize(4, nb_points));
+  for (unsigned int m(1); m < 5; m++) {
+    fdcoef(m, nb_points, xgrid[10], &xgrid[6], coef.data(), work.data());
+    vector<double> expected = fdcoef(m, nb_points, xgrid[10], xgrid.begin() + 6);
+    for (int j(0); j < nb_points; j++)
+      EXPECT_DOUBLE_EQ(coef[j], expected[j]);
+  }
+}
+
+// wide stencils only need O(m n) memory
+// (a [m][n][n] array of long double would not fit on the stack)
+TEST(wideStencil, CentralFirstDerivative) {
+  unsigned int ngrid(1201), nb_points(601);
+  vector<double> xgrid(ngrid);
+  for (int i(0); i < ngrid; i++)
+    xgrid[i] = double(i) / 220.0;
+
+  vector<double> coef(nb_points);
+  vector<long double> work(fdcoef_worksize(2, nb_points));
+  size_t mid((ngrid - 1) / 2);
+  fdcoef(2, nb_points, xgrid[mid], &xgrid[mid - (nb_points - 1) / 2], coef.data(), work.data());
+
+  // central weights: (-1)^(k+1) (p!)^2 / (k (p-k)! (p+k)!) / h
+  double h(1.0 / 220.0), p((nb_points - 1) / 2);
+  size_t c((nb_points - 1) / 2);
+  EXPECT_NEAR(coef[c] * h, 0.0, 1e-10);
+  EXPECT_NEAR(coef[c + 1] * h, p / (p + 1.0), 1e-10);
+  EXPECT_NEAR(coef[c - 1] * h, -p / (p + 1.0), 1e-10);
+  EXPECT_NEAR(coef[c + 2] * h, -0.5 * p * (p - 1.0) / ((p + 1.0) * (p + 2.0)), 1e-10);
+}
+
+// compile-time sizes give the same coefficients
+TEST_F(nonUniformGrid, FixedSizeCoefficients) {
+  array<double, 7> coef = fdcoef<3, 7>(xgrid[20], &xgrid[17]);
+  vector<double> expected = fdcoef(3, 7, xgrid[20], xgrid.begin() + 17);
+  for (int j(0); j < 7; j++)
+    EXPECT_DOUBLE_EQ(coef[j], expected[j]);
+
+  array<double, 4> back = fdcoef<2, 4>(xgrid[ngrid - 1], &xgrid[ngrid - 4]);
+  expected = fdcoef(2, 4, xgrid[ngrid - 1], xgrid.end() - 4);
+  for (int j(0); j < 4; j++)
+    EXPECT_DOUBLE_EQ(back[j], expected[j]);
+}
+
+TEST_F(nonUniformGrid, FixedSizeDerivatives) {
+  vector<double> du = fd<2, 5>(xgrid, f);
+  vector<double> expected = fd(2, 5, xgrid, f);
+  ASSERT_EQ(du.size(), ngrid);
+  for (int i(0); i < ngrid; i++)
+    EXPECT_NEAR(du[i], expected[i], 1e-9);
+
+  du = fd<4, 8>(xgrid, f);
+  expected = fd(4, 8, xgrid, f);
+  for (int i(0); i < ngrid; i++)
+    EXPECT_NEAR(du[i], expected[i], 1e-9);
+}
+
+// the threaded version gives bit identical results (the grid is
+// large enough for 8 chunks of NUFD_THREAD_CHUNK points)
+TEST(threadedFd, SameAsSerial) {
+  size_t ngrid(40007);
+  vector<double> xgrid = random_grid(ngrid, 7, 1e-3, 1e-3), ugrid(ngrid, 0.0), f(ngrid, 0.0);
+  for (size_t i(1); i < ngrid; i++)
+    ugrid[i] = 2e-3 * i;
+  for (size_t i(0); i < ngrid; i++)
+    f[i] = sin(xgrid[i]);
+
+  unsigned int nthreads[] = {2, 3, 8, 0};
+  for (unsigned int n(5); n < 9; n += 3) {
+    vector<double> serial = fd(3, n, xgrid, f);
+    vector<double> userial = fd(3, n, ugrid, f);
+    for (unsigned int t : nthreads) {
+      vector<double> du = fd(3, n, xgrid, f, t);
+      vector<double> uu = fd(3, n, ugrid, f, t);
+      ASSERT_EQ(du.size(), ngrid);
+      for (size_t i(0); i < ngrid; i++) {
+        ASSERT_EQ(du[i], serial[i]) << "n = " << n << ", threads = " << t << ", i = " << i;
+        ASSERT_EQ(uu[i], userial[i]) << "n = " << n << ", threads = " << t << ", i = " << i;
+      }
+    }
+  }
+}
+
+// values and derivatives between the grid points
+TEST_F(nonUniformGrid, OffGridEvaluation) {
+  vector<double> xq;
+  std::mt19937_64 rng(17);
+  uniform_real_distribution<double> unif(xgrid[0], xgrid[ngrid - 1]);
+  for (int q(0); q < 500; q++)
+    xq.push_back(unif(rng));
+
+  vector<vector<double> > unsorted = fd_eval_all(3, 8, xgrid, f, xq);
+  vector<double> d1 = fd_eval(2, 8, xgrid, f, xq);
+  ASSERT_EQ(unsorted.size(), 3);
+  for (size_t q(0); q < xq.size(); q++) {
+    EXPECT_NEAR(unsorted[0][q], sin(xq[q]), 1e-10);
+    EXPECT_NEAR(unsorted[1][q], cos(xq[q]), 1e-8);
+    EXPECT_NEAR(unsorted[2][q], -sin(xq[q]), 1e-6);
+    EXPECT_DOUBLE_EQ(d1[q], unsorted[1][q]);
+  }
+
+  // the merge-walk of sorted queries finds the same stencils
+  vector<double> xs(xq);
+  sort(xs.begin(), xs.end());
+  vector<vector<double> > sorted = fd_eval_all(3, 8, xgrid, f, xs);
+  for (size_t q(0); q < xq.size(); q++) {
+    size_t s(lower_bound(xs.begin(), xs.end(), xq[q]) - xs.begin());
+    for (int k(0); k < 3; k++)
+      EXPECT_EQ(sorted[k][s], unsorted[k][q]);
+  }
+
+  // on the grid points the value is exact
+  vector<double> v = fd_eval(1, 5, xgrid, f, xgrid);
+  for (int i(0); i < ngrid; i++)
+    EXPECT_NEAR(v[i], f[i], 1e-14);
+}
+
+// periodic domain without ghost points
+TEST(periodicGrid, WrappedStencils) {
+  size_t ngrid(64);
+  double period(2.0 * M_PI);
+  vector<double> xgrid(ngrid), f(ngrid);
+  std::mt19937_64 rng(23);
+  uniform_real_distribution<double> unif(-0.3, 0.3);
+  for (size_t i(0); i < ngrid; i++) {
+    xgrid[i] = period * (i + unif(rng)) / ngrid + 1.0;
+    f[i] = sin(xgrid[i]);
+  }
+
+  vector<double> du = fd_periodic(2, 7, xgrid, f, period);
+  vector<double> d3 = fd_periodic(4, 8, xgrid, f, period);
+  vector<double> central = fd(2, 7, xgrid, f);
+  ASSERT_EQ(du.size(), ngrid);
+  for (size_t i(0); i < ngrid; i++) {
+    // same accuracy at the seams as inside the domain
+    EXPECT_NEAR(du[i], cos(xgrid[i]), 1e-6) << "i = " << i;
+    EXPECT_NEAR(d3[i], -cos(xgrid[i]), 1e-3) << "i = " << i;
+
+    // same stencils as fd() away from the ends
+    if (i >= 3 && i < ngrid - 3)
+      EXPECT_DOUBLE_EQ(du[i], central[i]);
+  }
+}
+
+// instrumentation counters (zero unless built with NUFD_STATS)
+TEST_F(nonUniformGrid, StatsCounters) {
+  fd_stats_reset();
+  vector<double> du = fd(2, 5, xgrid, f);
+  FdStats stats = fd_stats();
+
+#ifdef NUFD_STATS
+  EXPECT_EQ(stats.fdcoef_calls, ngrid);
+  EXPECT_EQ(stats.points, ngrid);
+  EXPECT_GT(stats.allocations, 0u);
+  EXPECT_GE(stats.boundary_time + stats.interior_time, stats.coef_time);
+#else
+  EXPECT_EQ(stats.fdcoef_calls, 0u);
+  EXPECT_EQ(stats.points, 0u);
+  EXPECT_EQ(stats.allocations, 0u);
+  EXPECT_EQ(stats.coef_time, 0.0);
+#endif
+
+#ifdef NUFD_STATS
+  // the workers of fd() time their own chunks
+  fd_stats_reset();
+  du = fd(2, 5, xgrid, f, 4);
+  stats = fd_stats();
+  EXPECT_EQ(stats.points, ngrid);
+  EXPECT_GE(stats.boundary_time + stats.interior_time, stats.coef_time);
+
+  // the other entry points count their points too
+  fd_stats_reset();
+  vector<vector<double> > all = fd_all(3, 5, xgrid, f);
+  EXPECT_EQ(fd_stats().points, 3 * ngrid);
+  EXPECT_GT(fd_stats().allocations, 0u);
+#endif
+
+  fd_stats_reset();
+  EXPECT_EQ(fd_stats().fdcoef_calls, 0u);
+}
+
+// strided columns of records written in place
+TEST_F(nonUniformGrid, StridedBuffers) {
+  struct record {
+    double x, u, du;
+  };
+  vector<record> data(ngrid);
+  for (int i(0); i < ngrid; i++) {
+    data[i].x = xgrid[i];
+    data[i].u = f[i];
+    data[i].du = 0.0;
+  }
+
+  size_t stride(sizeof(record) / sizeof(double));
+  vector<double> coef(2 * 5);
+  vector<long double> work(fdcoef_worksize(2, 5));
+  fd(2, 5, ngrid, &data[0].x, stride, &data[0].u, stride, &data[0].du, stride, coef.data(), work.data());
+
+  vector<double> ref = fd(2, 5, xgrid, f);
+  for (int i(0); i < ngrid; i++)
+    EXPECT_NEAR(data[i].du, ref[i], 1e-12) << "i = " << i;
+
+  // contiguous buffers
+  vector<double> du(ngrid, 0.0);
+  fd(2, 5, ngrid, xgrid.data(), 1, f.data(), 1, du.data(), 1, coef.data(), work.data());
+  for (int i(0); i < ngrid; i++)
+    EXPECT_NEAR(du[i], ref[i], 1e-12) << "i = " << i;
+}
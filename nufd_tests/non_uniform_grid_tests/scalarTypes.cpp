@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+#include "fdtyped.h"
+
+// accuracy of the storage / weight types combinations on a
+// non-uniform grid (spacing 0.02 to 0.07) for sin(x) with 7 points,
+// maximum errors measured and bounds used below:
+//
+//   storage  weights      1st diff          2nd diff
+//   double   long double  3.2e-9  (1e-8)    2.9e-7 (1e-6)   truncation error
+//   double   double       3.2e-9  (1e-8)    2.9e-7 (1e-6)
+//   float    double       4.5e-6  (1e-5)    2.8e-4 (5e-4)   float rounding
+//   float    float        1.4e-5  (3e-5)    5.4e-4 (1e-3)
+template <typename T, typename W>
+static void max_errors(double &e1, double &e2) {
+  size_t ngrid(200);
+  vector<T> x(ngrid, T(0)), f(ngrid, T(0));
+  std::mt19937_64 rng(2016);
+  uniform_real_distribution<double> unif(0.02, 0.07);
+  double xi(0.0);
+  for (size_t i(0); i < ngrid; i++) {
+    x[i] = T(xi);
+    f[i] = T(sin(double(x[i])));
+    xi = xi + unif(rng);
+  }
+
+  vector<T> d1 = fd<T, W>(2, 7, x, f);
+  vector<T> d2 = fd<T, W>(3, 7, x, f);
+  e1 = e2 = 0.0;
+  for (size_t i(0); i < ngrid; i++) {
+    e1 = max(e1, fabs(double(d1[i]) - cos(double(x[i]))));
+    e2 = max(e2, fabs(double(d2[i]) + sin(double(x[i]))));
+  }
+}
+
+TEST(scalarTypes, DoubleLongDouble) {
+  double e1, e2;
+  max_errors<double, long double>(e1, e2);
+  EXPECT_LT(e1, 1e-8);
+  EXPECT_LT(e2, 1e-6);
+}
+
+TEST(scalarTypes, DoubleDouble) {
+  double e1, e2;
+  max_errors<double, double>(e1, e2);
+  EXPECT_LT(e1, 1e-8);
+  EXPECT_LT(e2, 1e-6);
+}
+
+TEST(scalarTypes, FloatDouble) {
+  double e1, e2;
+  max_errors<float, double>(e1, e2);
+  EXPECT_LT(e1, 1e-5);
+  EXPECT_LT(e2, 5e-4);
+}
+
+TEST(scalarTypes, FloatFloat) {
+  double e1, e2;
+  max_errors<float, float>(e1, e2);
+  EXPECT_LT(e1, 3e-5);
+  EXPECT_LT(e2, 1e-3);
+}
+
+// double storage selects the functions of nufd.h
+TEST(scalarTypes, DoubleStorage) {
+  vector<double> x(20), f(20);
+  for (size_t i(0); i < 20; i++) {
+    x[i] = 0.1 * i + 0.01 * (i % 3);
+    f[i] = exp(x[i]);
+  }
+  vector<double> typed = fd<double, long double>(2, 5, x, f);
+  vector<double> du = fd(2, 5, x, f);
+  for (size_t i(0); i < 20; i++)
+    EXPECT_NEAR(typed[i], du[i], 1e-12);
+
+  vector<float> xf(x.begin(), x.end());
+  vector<float> coef = fdcoef<float>(2, 5, xf[3], xf.begin() + 1);
+  vector<double> expected = fdcoef(2, 5, x[3], x.begin() + 1);
+  for (size_t j(0); j < 5; j++)
+    EXPECT_NEAR(coef[j], expected[j], 1e-4 * fabs(expected[j]));
+}
+
+// one point stencils (no forward or backward point) copy the values
+TEST(scalarTypes, OnePoint) {
+  vector<float> x(10), f(10);
+  for (size_t i(0); i < 10; i++) {
+    x[i] = 0.1f * i;
+    f[i] = sin(x[i]);
+  }
+  vector<float> du = fd<float, double>(1, 1, x, f);
+  ASSERT_EQ(du.size(), 10);
+  for (size_t i(0); i < 10; i++)
+    EXPECT_EQ(du[i], f[i]);
+
+  vector<float> d2 = fd<float, double>(2, 2, x, f);
+  for (size_t i(0); i < 9; i++)
+    EXPECT_NEAR(d2[i], (f[i + 1] - f[i]) / (x[i + 1] - x[i]), 1e-4);
+  EXPECT_NEAR(d2[9], (f[9] - f[8]) / (x[9] - x[8]), 1e-4);
+}
@@ -0,0 +1,102 @@
+#include "gtest/gtest.h"
+#include "fdcompact.h"
+#include "grid.h"
+
+class fdCompact: public ::testing::Test {
+ protected:
+
+  // fixture used in all test cases
+  virtual void SetUp() {
+    ngrid = 500;
+    smooth.resize(ngrid);
+    f.resize(ngrid);
+
+    // random spacing and smoothly stretched grids
+    xgrid = random_grid(ngrid, 2024, 0.005, 0.01);
+    for (int i(0); i < ngrid; i++) {
+      double t(double(i) / double(ngrid - 1));
+      smooth[i] = 3.0 * t + 0.5 * t * t * t;
+    }
+
+    for (int i(0); i < ngrid; i++)
+      f[i] = sin(xgrid[i]);
+  }
+  virtual void TearDown() {}
+
+  // largest difference between the compact and full plans, relative
+  // to sum(|w[j]|) * max(|u[j]|) (the bound given by error())
+  double apply_error(const FdPlan &plan, const FdCompactPlan &compact, const vector<double> &u) {
+    vector<double> du = plan.apply(u);
+    vector<double> dc = compact.apply(u);
+    double e(0.0);
+    for (size_t i(0); i < plan.size(); i++) {
+      const double *w(plan.weights(i));
+      double sw(0.0), su(0.0);
+      for (unsigned int j(0); j < plan.points(); j++) {
+        sw = sw + fabs(w[j]);
+        su = max(su, fabs(u[plan.offset(i) + j]));
+      }
+      e = max(e, fabs(dc[i] - du[i]) / (sw * su));
+    }
+    return e;
+  }
+
+  unsigned int ngrid;
+  vector<double> xgrid;
+  vector<double> smooth;
+  vector<double> f;
+};
+
+// the error of the sweep is within the measured bound
+TEST_F(fdCompact, ErrorBound) {
+  FdCompactFormat formats[] = {FDCOMPACT_FLOAT, FDCOMPACT_DELTA};
+  for (FdCompactFormat fmt : formats)
+    for (unsigned int m(1); m < 5; m++)
+      for (unsigned int n(m); n < 10; n++) {
+        FdPlan plan(m, n, xgrid);
+        FdCompactPlan compact(plan, fmt);
+        EXPECT_LE(compact.error(), 1e-6);
+        EXPECT_LE(apply_error(plan, compact, f), compact.error() + 1e-14)
+            << "format = " << fmt << ", m = " << m << ", n = " << n;
+      }
+}
+
+// float weights: half of the memory, single precision weights
+TEST_F(fdCompact, Float) {
+  FdPlan plan(2, 5, xgrid);
+  FdCompactPlan compact(plan, FDCOMPACT_FLOAT);
+  EXPECT_EQ(compact.bytes(), 5 * sizeof(float));
+  EXPECT_LT(compact.error(), 1e-7);
+}
+
+// the corrections are small on smooth grids, and zero on uniform
+// grids (up to the rounding of the weights of the plan)
+TEST_F(fdCompact, Delta) {
+  for (unsigned int n(3); n < 10; n++) {
+    FdCompactPlan compact(FdPlan(2, n, smooth), FDCOMPACT_DELTA);
+    EXPECT_EQ(compact.bytes(), (n + 1) * sizeof(float));
+    EXPECT_LT(compact.error(), 1e-9) << "n = " << n;
+  }
+
+  vector<double> uniform(ngrid);
+  for (int i(0); i < ngrid; i++)
+    uniform[i] = 0.01 * i;
+  FdCompactPlan compact(FdPlan(3, 7, uniform), FDCOMPACT_DELTA);
+  EXPECT_LT(compact.error(), 1e-13);
+}
+
+// the compact plans of a smooth grid follow the full plan
+TEST_F(fdCompact, SameAsPlan) {
+  vector<double> u(ngrid);
+  for (int i(0); i < ngrid; i++)
+    u[i] = sin(smooth[i]);
+
+  FdPlan plan(2, 7, smooth);
+  vector<double> du = plan.apply(u);
+  vector<double> df = FdCompactPlan(plan, FDCOMPACT_FLOAT).apply(u);
+  vector<double> dd = FdCompactPlan(plan, FDCOMPACT_DELTA).apply(u);
+  for (int i(0); i < ngrid; i++) {
+    EXPECT_NEAR(df[i], du[i], 1e-4) << "i = " << i;
+    EXPECT_NEAR(dd[i], du[i], 1e-7) << "i = " << i;
+  }
+}
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+#include "fdmatrix.h"
+#include "grid.h"
+
+class fdMatrix: public ::testing::Test {
+ protected:
+
+  // fixture used in all test cases
+  virtual void SetUp() {
+    ngrid = 80;
+    f.resize(ngrid);
+
+    // non-uniform grid with a fixed seed
+    xgrid = random_grid(ngrid, 42, 0.01, 0.01);
+
+    for (int i(0); i < ngrid; i++)
+      f[i] = sin(xgrid[i]);
+  }
+  virtual void TearDown() {}
+
+  unsigned int ngrid;
+  vector<double> xgrid;
+  vector<double> f;
+};
+
+// the matrices give the same product as the plan
+TEST_F(fdMatrix, MatrixVectorProduct) {
+  for (unsigned int n(3); n < 9; n++) {
+    FdPlan plan(2, n, xgrid);
+    FdBandMatrix band = fd_band(plan);
+    FdCsrMatrix csr = fd_csr(plan);
+    EXPECT_EQ(band.kl, n - 1);
+    EXPECT_EQ(band.ku, n - 1);
+    EXPECT_EQ(band.cl + band.cu, n - 1);
+    EXPECT_EQ(csr.rowptr[ngrid], ngrid * n);
+
+    vector<double> expected = plan.apply(f), yb(ngrid), yc(ngrid);
+    band_mult(band, f.data(), yb.data());
+    csr_mult(csr, f.data(), yc.data());
+    for (int i(0); i < ngrid; i++) {
+      EXPECT_NEAR(yb[i], expected[i], 1e-10);
+      EXPECT_NEAR(yc[i], expected[i], 1e-10);
+    }
+  }
+}
+
+// implicit step (I - dt D2) u = f
+TEST_F(fdMatrix, BandedSolve) {
+  FdPlan plan(3, 5, xgrid);
+  FdBandMatrix a = fd_band(plan);
+  double dt(1e-3);
+  for (size_t k(0); k < a.ab.size(); k++)
+    a.ab[k] = -dt * a.ab[k];
+  for (size_t i(0); i < ngrid; i++)
+    a(i, i) = a(i, i) + 1.0;
+
+  FdBandLU lu;
+  ASSERT_TRUE(band_lu(a, lu));
+  vector<double> u(f);
+  band_solve(lu, u.data());
+
+  vector<double> r(ngrid);
+  band_mult(a, u.data(), r.data());
+  for (int i(0); i < ngrid; i++)
+    EXPECT_NEAR(r[i], f[i], 1e-12);
+}
+
+// non-symmetric operator u + du/dx = f, the pivoting
+// handles the wide forward and backward rows
+TEST_F(fdMatrix, FirstDerivativeSolve) {
+  FdBandMatrix a = fd_band(FdPlan(2, 6, xgrid));
+  vector<double> ones(ngrid, 1.0), y(ngrid);
+  band_mult(a, ones.data(), y.data());
+  for (int i(0); i < ngrid; i++)
+    EXPECT_NEAR(y[i], 0.0, 1e-9);
+
+  for (size_t i(0); i < ngrid; i++)
+    a(i, i) = a(i, i) + 1.0;
+  FdBandLU lu;
+  ASSERT_TRUE(band_lu(a, lu));
+  vector<double> u(f);
+  band_solve(lu, u.data());
+  band_mult(a, u.data(), y.data());
+  for (int i(0); i < ngrid; i++)
+    EXPECT_NEAR(y[i], f[i], 1e-10);
+}
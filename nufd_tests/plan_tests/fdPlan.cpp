@@ -0,0 +1,168 @@
+#include "gtest/gtest.h"
+#include "fdplan.h"
+#include "grid.h"
+
+class fdPlan: public ::testing::Test {
+ protected:
+
+  // fixture used in all test cases
+  virtual void SetUp() {
+    ngrid = 50;
+    f.resize(ngrid);
+
+    // non-uniform grid with a fixed seed
+    xgrid = random_grid(ngrid, 12345, 0.02, 0.05);
+
+    for (int i(0); i < ngrid; i++)
+      f[i] = sin(xgrid[i]);
+  }
+  virtual void TearDown() {}
+
+  unsigned int ngrid;
+  // rounding bound of two evaluations of the stencil sum at point i
+  // with differently contracted multiply-adds: 2 n eps sum(|w[j] u[j]|)
+  double tolerance(const FdPlan &plan, size_t i, const vector<double> &u) {
+    const double *w(plan.weights(i));
+    double sum(0.0);
+    for (unsigned int j(0); j < plan.points(); j++)
+      sum = sum + fabs(w[j] * u[plan.offset(i) + j]);
+    return 2.0 * plan.points() * numeric_limits<double>::epsilon() * sum;
+  }
+
+  vector<double> xgrid;
+  vector<double> f;
+};
+
+// the plan must reproduce fd() up to the rounding of the
+// stencil sums (multiply-adds can be contracted differently)
+TEST_F(fdPlan, SameAsFdOddPoints) {
+  for (unsigned int m(1); m < 5; m++) {
+    FdPlan plan(m, 7, xgrid);
+    vector<double> du = fd(m, 7, xgrid, f);
+    vector<double> dp = plan.apply(f);
+    ASSERT_EQ(dp.size(), ngrid);
+    for (int i(0); i < ngrid; i++)
+      EXPECT_NEAR(dp[i], du[i], tolerance(plan, i, f)) << "m = " << m << ", i = " << i;
+  }
+}
+
+TEST_F(fdPlan, SameAsFdEvenPoints) {
+  for (unsigned int m(1); m < 5; m++) {
+    FdPlan plan(m, 8, xgrid);
+    vector<double> du = fd(m, 8, xgrid, f);
+    vector<double> dp = plan.apply(f);
+    ASSERT_EQ(dp.size(), ngrid);
+    for (int i(0); i < ngrid; i++)
+      EXPECT_NEAR(dp[i], du[i], tolerance(plan, i, f)) << "m = " << m << ", i = " << i;
+  }
+}
+
+// stencils stay inside the grid
+TEST_F(fdPlan, Offsets) {
+  FdPlan plan(2, 8, xgrid);
+  EXPECT_EQ(plan.offset(0), 0);
+  EXPECT_EQ(plan.offset(3), 0);
+  EXPECT_EQ(plan.offset(4), 1);
+  EXPECT_EQ(plan.offset(ngrid - 5), ngrid - 8);
+  EXPECT_EQ(plan.offset(ngrid - 4), ngrid - 8);
+  EXPECT_EQ(plan.offset(ngrid - 1), ngrid - 8);
+}
+
+// reuse of the plan for another field
+TEST_F(fdPlan, FirstDerivative) {
+  FdPlan plan(2, 7, xgrid);
+  vector<double> g(ngrid);
+  for (int i(0); i < ngrid; i++)
+    g[i] = cos(xgrid[i]);
+
+  vector<double> df = plan.apply(f);
+  vector<double> dg = plan.apply(g);
+  for (int i(0); i < ngrid; i++) {
+    EXPECT_NEAR(df[i], cos(xgrid[i]), 1e-8);
+    EXPECT_NEAR(dg[i], -sin(xgrid[i]), 1e-8);
+  }
+}
+
+// interleaved fields give the same result as one field at a time
+TEST_F(fdPlan, InterleavedFields) {
+  size_t nfields(5);
+  vector<double> u(ngrid * nfields);
+  for (int i(0); i < ngrid; i++)
+    for (size_t k(0); k < nfields; k++)
+      u[i * nfields + k] = sin((k + 1) * xgrid[i]);
+
+  FdPlan plan(3, 7, xgrid);
+  vector<double> du = plan.apply(u, nfields);
+  vector<double> db = fd_batch(3, 7, xgrid, u, nfields);
+  ASSERT_EQ(du.size(), ngrid * nfields);
+  ASSERT_EQ(db.size(), ngrid * nfields);
+  for (size_t k(0); k < nfields; k++) {
+    vector<double> uk(ngrid);
+    for (int i(0); i < ngrid; i++)
+      uk[i] = u[i * nfields + k];
+    vector<double> dk = fd(3, 7, xgrid, uk);
+    for (int i(0); i < ngrid; i++) {
+      EXPECT_NEAR(du[i * nfields + k], dk[i], 1e-12 * (1.0 + fabs(dk[i])));
+      EXPECT_NEAR(db[i * nfields + k], dk[i], 1e-12 * (1.0 + fabs(dk[i])));
+    }
+  }
+}
+
+// the adjoint satisfies <D u, v> = <u, D^T v>
+TEST_F(fdPlan, Transpose) {
+  FdPlan plan(3, 6, xgrid);
+  vector<double> v(ngrid);
+  for (int i(0); i < ngrid; i++)
+    v[i] = exp(-xgrid[i]);
+
+  vector<double> du = plan.apply(f);
+  vector<double> dtv = plan.apply_transpose(v);
+  double left(0.0), right(0.0), scale(0.0);
+  for (int i(0); i < ngrid; i++) {
+    left = left + du[i] * v[i];
+    right = right + f[i] * dtv[i];
+    scale = scale + fabs(f[i] * dtv[i]);
+  }
+  EXPECT_NEAR(left, right, 1e-13 * scale);
+
+  // columns of D are the rows of D^T
+  for (int k(0); k < ngrid; k += 7) {
+    vector<double> e(ngrid, 0.0);
+    e[k] = 1.0;
+    vector<double> column = plan.apply(e);
+    for (int i(0); i < ngrid; i++) {
+      vector<double> ei(ngrid, 0.0);
+      ei[i] = 1.0;
+      EXPECT_EQ(plan.apply_transpose(ei)[k], column[i]);
+    }
+  }
+
+  // fused sweep
+  vector<double> db(ngrid), dtb(ngrid);
+  plan.apply_both(f.data(), db.data(), v.data(), dtb.data());
+  for (int i(0); i < ngrid; i++) {
+    EXPECT_EQ(db[i], du[i]);
+    EXPECT_EQ(dtb[i], dtv[i]);
+  }
+}
+
+// a u' + b u'' + c u as a single stencil
+TEST_F(fdPlan, LinearOperator) {
+  vector<vector<double> > c(3, vector<double>(ngrid));
+  for (int i(0); i < ngrid; i++) {
+    c[0][i] = 1.0 + xgrid[i];
+    c[1][i] = cos(xgrid[i]);
+    c[2][i] = -0.5 * xgrid[i] * xgrid[i];
+  }
+
+  vector<double> d1 = fd(2, 7, xgrid, f);
+  vector<double> d2 = fd(3, 7, xgrid, f);
+  vector<double> lu = fd_op(7, xgrid, c, f);
+  vector<double> lp = FdPlan(7, xgrid, c).apply(f);
+  ASSERT_EQ(lu.size(), ngrid);
+  for (int i(0); i < ngrid; i++) {
+    double expected(c[0][i] * f[i] + c[1][i] * d1[i] + c[2][i] * d2[i]);
+    EXPECT_NEAR(lu[i], expected, 1e-9);
+    EXPECT_NEAR(lp[i], expected, 1e-9);
+  }
+}
@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include "fdnd.h"
+#include "grid.h"
+
+class rectilinearGrid: public ::testing::Test {
+ protected:
+
+  // fixture used in all test cases
+  virtual void SetUp() {
+    shape = {13, 11, 17};
+
+    // one non-uniform grid per axis
+    grids.resize(3);
+    for (size_t d(0); d < 3; d++)
+      grids[d] = random_grid(shape[d], 3 + d, 0.05, 0.05);
+
+    f.resize(shape[0] * shape[1] * shape[2]);
+    for (size_t i(0); i < shape[0]; i++)
+      for (size_t j(0); j < shape[1]; j++)
+        for (size_t k(0); k < shape[2]; k++)
+          f[index(i, j, k)] = sin(grids[0][i]) * cos(grids[1][j]) * exp(grids[2][k]);
+  }
+  virtual void TearDown() {}
+
+  size_t index(size_t i, size_t j, size_t k) { return (i * shape[1] + j) * shape[2] + k; }
+
+  // derivative along one axis computed pencil by pencil with fd()
+  vector<double> pencils(unsigned int m, unsigned int n, size_t axis, const vector<double> &u) {
+    vector<double> du(u.size());
+    size_t stride[3] = {shape[1] * shape[2], shape[2], 1};
+    for (size_t p(0); p < u.size(); p++) {
+      // first point of each pencil
+      if ((p / stride[axis]) % shape[axis] != 0)
+        continue;
+      vector<double> pencil(shape[axis]);
+      for (size_t i(0); i < shape[axis]; i++)
+        pencil[i] = u[p + i * stride[axis]];
+      vector<double> dp = fd(m, n, grids[axis], pencil);
+      for (size_t i(0); i < shape[axis]; i++)
+        du[p + i * stride[axis]] = dp[i];
+    }
+    return du;
+  }
+
+  vector<size_t> shape;
+  vector<vector<double> > grids;
+  vector<double> f;
+};
+
+TEST_F(rectilinearGrid, EveryAxis) {
+  for (size_t axis(0); axis < 3; axis++) {
+    vector<double> du = fd_axis(2, 5, grids[axis], shape, axis, f);
+    vector<double> expected = pencils(2, 5, axis, f);
+    ASSERT_EQ(du.size(), f.size());
+    for (size_t p(0); p < f.size(); p++)
+      EXPECT_NEAR(du[p], expected[p], 1e-10) << "axis = " << axis << ", p = " << p;
+  }
+}
+
+TEST_F(rectilinearGrid, InPlace) {
+  for (size_t axis(0); axis < 3; axis++) {
+    FdPlan plan(3, 6, grids[axis]);
+    vector<double> u(f);
+    fd_axis(plan, shape, axis, u.data(), u.data());
+    vector<double> expected = fd_axis(3, 6, grids[axis], shape, axis, f);
+    for (size_t p(0); p < f.size(); p++)
+      EXPECT_EQ(u[p], expected[p]) << "axis = " << axis << ", p = " << p;
+  }
+}
+
+TEST_F(rectilinearGrid, MixedDerivative) {
+  FdPlan dx(2, 7, grids[0]), dz(2, 7, grids[2]);
+  vector<double> du(f.size());
+  fd_mixed(dx, 0, dz, 2, shape, f.data(), du.data());
+  for (size_t i(0); i < shape[0]; i++)
+    for (size_t j(0); j < shape[1]; j++)
+      for (size_t k(0); k < shape[2]; k++)
+        EXPECT_NEAR(du[index(i, j, k)], cos(grids[0][i]) * cos(grids[1][j]) * exp(grids[2][k]),
+                    1e-5 * exp(grids[2][k]));
+}
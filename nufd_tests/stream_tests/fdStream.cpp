@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+#include "fdplan.h"
+#include "fdstream.h"
+#include "grid.h"
+
+class fdStream: public ::testing::Test {
+ protected:
+
+  // fixture used in all test cases
+  virtual void SetUp() {
+    ngrid = 1000;
+    f.resize(ngrid);
+
+    // non-uniform grid with a fixed seed
+    xgrid = random_grid(ngrid, 99, 0.005, 0.01);
+
+    for (int i(0); i < ngrid; i++)
+      f[i] = sin(xgrid[i]);
+  }
+  virtual void TearDown() {}
+
+  // stream the grid by chunks of random sizes
+  vector<double> stream(unsigned int m, unsigned int n, size_t max_chunk) {
+    FdStream s(m, n);
+    vector<double> du;
+    std::mt19937_64 rng(5);
+    uniform_int_distribution<size_t> chunk(0, max_chunk);
+    size_t i(0);
+    while (i < ngrid) {
+      size_t count(min(chunk(rng), ngrid - i));
+      s.push(&xgrid[i], &f[i], count, du);
+      i += count;
+      EXPECT_EQ(du.size(), s.emitted());
+    }
+    s.finish(du);
+    EXPECT_EQ(s.received(), ngrid);
+    return du;
+  }
+
+  unsigned int ngrid;
+  vector<double> xgrid;
+  vector<double> f;
+};
+
+TEST_F(fdStream, SameAsPlan) {
+  size_t chunks[] = {1, 7, 100, 5000};
+  for (unsigned int n(3); n < 10; n++) {
+    vector<double> expected = FdPlan(2, n, xgrid).apply(f);
+    for (size_t c : chunks) {
+      vector<double> du = stream(2, n, c);
+      ASSERT_EQ(du.size(), ngrid);
+      for (int i(0); i < ngrid; i++)
+        EXPECT_NEAR(du[i], expected[i], 1e-12) << "n = " << n << ", chunk = " << c << ", i = " << i;
+    }
+  }
+}
+
+// derivatives are emitted as soon as their stencil is complete
+TEST_F(fdStream, EmitAsSoonAsFinal) {
+  FdStream s(2, 5);
+  vector<double> du;
+  s.push(&xgrid[0], &f[0], 4, du);
+  EXPECT_EQ(du.size(), 0);
+  s.push(&xgrid[4], &f[4], 1, du);
+  EXPECT_EQ(du.size(), 3);
+  s.push(&xgrid[5], &f[5], 1, du);
+  EXPECT_EQ(du.size(), 4);
+  s.finish(du);
+  EXPECT_EQ(du.size(), 6);
+}
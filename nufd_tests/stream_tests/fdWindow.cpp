@@ -0,0 +1,37 @@
+#include "gtest/gtest.h"
+#include "fdwindow.h"
+#include "grid.h"
+
+// the window gives the weights of fdcoef at the newest sample
+TEST(fdWindow, SameAsFdcoef) {
+  size_t ngrid(5000);
+  vector<double> x = random_grid(ngrid, 11, 0.01, 0.01), f(ngrid, 0.0);
+  for (size_t i(0); i < ngrid; i++)
+    f[i] = sin(x[i]);
+
+  for (unsigned int m(1); m < 5; m++) {
+    unsigned int n(7);
+    FdWindow window(m, n);
+    for (size_t i(0); i < ngrid; i++) {
+      double du(window.push(x[i], f[i]));
+      if (i + 1 < m) {
+        EXPECT_TRUE(std::isnan(du));
+        continue;
+      }
+
+      // shorter stencil until the window is full
+      unsigned int nb_points(min(size_t(n), i + 1));
+      EXPECT_EQ(window.full(), nb_points == n);
+      vector<double> coef = fdcoef(m, nb_points, x[i], x.begin() + (i + 1 - nb_points));
+      double expected(0.0), scale(0.0);
+      for (int j(0); j < nb_points; j++) {
+        EXPECT_NEAR(window.weights()[j], coef[j], 1e-9 * (1.0 + fabs(coef[j]))) << "m = " << m << ", i = " << i;
+        expected = expected + coef[j] * f[i + 1 - nb_points + j];
+        scale = scale + fabs(coef[j] * f[i + 1 - nb_points + j]);
+      }
+
+      // same rounding as a sum of nb_points weighted values
+      EXPECT_NEAR(du, expected, 1e-12 * scale);
+    }
+  }
+}
@@ -1,5 +1,7 @@
 #include "gtest/gtest.h"
 #include "nufd.h"
+#include "fdplan.h"
+#include "fdtable.h"
 
 class uniformGrid: public ::testing::Test {
  protected:
@@ -567,6 +569,71 @@ TEST_F(uniformGrid, ForwardSchemeD4O5) {
   EXPECT_DOUBLE_EQ(coef[8] * pow(grid_size, 4.0), 967.0 / 240.0);
 }
 
+// compile-time tables
+static_assert(fdtable<2, 3>::weights[3] == -0.5, "central first derivative");
+static_assert(fdtable<3, 3>::weights[4] == -2.0, "central second derivative");
+
+TEST_F(uniformGrid, TablesMatchFdcoef) {
+  for (unsigned int m(1); m <= FDTABLE_MMAX; m++) {
+    for (unsigned int n(m); n <= FDTABLE_NMAX; n++) {
+      const double *table = fdtable_weights(m, n);
+      ASSERT_TRUE(table != nullptr) << "m = " << m << ", n = " << n;
+      for (int p(0); p < n; p++) {
+        vector<double> coef = fdcoef(m, n, xgrid[p], xgrid.begin());
+        for (int j(0); j < n; j++)
+          EXPECT_NEAR(table[p * n + j], coef[j] * pow(grid_size, m - 1.0), 1e-12 * (1.0 + fabs(table[p * n + j])));
+      }
+    }
+  }
+  EXPECT_TRUE(fdtable_weights(FDTABLE_MMAX + 1, FDTABLE_NMAX) == nullptr);
+  EXPECT_TRUE(fdtable_weights(2, FDTABLE_NMAX + 1) == nullptr);
+}
+
+// double-double recursion on the uniform grid
+TEST_F(uniformGrid, CompensatedMatchesTables) {
+  for (unsigned int m(1); m <= FDTABLE_MMAX; m++) {
+    for (unsigned int n(m); n <= FDTABLE_NMAX; n++) {
+      const double *table = fdtable_weights(m, n);
+      vector<double> coef(n), work(fdcoef_dd_worksize(m, n));
+      for (int p(0); p < n; p++) {
+        fdcoef_dd(m, n, xgrid[p], xgrid.data(), coef.data(), work.data());
+        for (int j(0); j < n; j++)
+          EXPECT_NEAR(table[p * n + j], coef[j] * pow(grid_size, m - 1.0), 1e-12 * (1.0 + fabs(table[p * n + j])));
+      }
+    }
+  }
+
+  // central first derivative with 5 points
+  vector<double> coef(5), work(fdcoef_dd_worksize(2, 5));
+  fdcoef_dd(2, 5, xgrid[4], &xgrid[2], coef.data(), work.data());
+  EXPECT_DOUBLE_EQ(coef[0] * grid_size, 1.0 / 12.0);
+  EXPECT_DOUBLE_EQ(coef[1] * grid_size, -2.0 / 3.0);
+  EXPECT_DOUBLE_EQ(coef[2] * grid_size, 0.0);
+  EXPECT_DOUBLE_EQ(coef[3] * grid_size, 2.0 / 3.0);
+  EXPECT_DOUBLE_EQ(coef[4] * grid_size, -1.0 / 12.0);
+}
+
+// fd() detects the uniform grid and uses the fixed weights
+TEST_F(uniformGrid, UniformFastPath) {
+  vector<double> f(ngrid);
+  for (int i(0); i < ngrid; i++)
+    f[i] = exp(xgrid[i]);
+
+  EXPECT_TRUE(fduniform(xgrid, NUFD_UNIFORM_RTOL));
+  for (unsigned int m(1); m < 5; m++) {
+    for (unsigned int n(m + 1); n < ngrid; n++) {
+      vector<double> du = fd(m, n, xgrid, f);
+      vector<double> dp = FdPlan(m, n, xgrid).apply(f);
+      for (int i(0); i < ngrid; i++)
+        EXPECT_NEAR(du[i], dp[i], 1e-8) << "m = " << m << ", n = " << n << ", i = " << i;
+    }
+  }
+
+  vector<double> ygrid(xgrid);
+  ygrid[4] += 1e-3 * grid_size;
+  EXPECT_FALSE(fduniform(ygrid, NUFD_UNIFORM_RTOL));
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
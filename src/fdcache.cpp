@@ -0,0 +1,94 @@
+#include "fdcache.h"
+#include "fdstats.h"
+
+FdCoefCache::FdCoefCache(unsigned int m, unsigned int n, double tol)
+    : m(m), n(n), tol(tol), nhits(0), nmisses(0), key(n), nodes(n), work(fdcoef_worksize(m, n)) {
+  assert(m > 0 && n > 0);
+  assert(tol > 0.0);
+  FDSTATS_COUNT(allocations, 3);
+}
+
+void FdCoefCache::coef(double x0, const double *grid, double *coef) {
+  // input:
+  // x0         = point at which to evaluate the coefficients
+  // grid[n]    = array containing the grid starting at the lowest bound
+  //              use during finite difference scheme
+
+  // output:
+  // coef[n]    = coefficients of the finite difference formula
+
+  // width of the stencil
+  double s(grid[n - 1] - grid[0]);
+  if (s == 0.0)
+    s = 1.0;
+
+  // normalized and quantized offsets
+  for (unsigned int j(0); j < n; j++) {
+    nodes[j] = (grid[j] - x0) / s;
+    key[j] = (long long)(floor(nodes[j] / tol + 0.5));
+  }
+
+  map<vector<long long>, vector<double> >::iterator it(table.find(key));
+  if (it == table.end()) {
+    // weights of the normalized stencil evaluated at 0
+    vector<double> w(n);
+    FDSTATS_COUNT(allocations, 2);
+    fdcoef(m, n, 0.0, nodes.data(), w.data(), work.data());
+    it = table.insert(make_pair(key, w)).first;
+    nmisses++;
+  } else {
+    nhits++;
+  }
+
+  // scale by s^(1-m)
+  double scale(1.0);
+  for (unsigned int k(1); k < m; k++)
+    scale = scale / s;
+  const double *w(it->second.data());
+  for (unsigned int j(0); j < n; j++)
+    coef[j] = w[j] * scale;
+}
+
+void FdCoefCache::clear() {
+  table.clear();
+  nhits = 0;
+  nmisses = 0;
+}
+
+vector<double> fd(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                  FdCoefCache &cache) {
+  // this routine computes the order m derivatives using n points on
+  // an arbitrary grid, the weights coming from the cache
+  // (the cache can be shared by successive calls on similar grids)
+
+  // input:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // grid[ngrid] = array of independent values
+  // u[ngrid]    = function values at the grid points
+  // cache       = weights of the spacing patterns (same m and n)
+
+  // output:
+  // du[ngrid]   = derivative values at the grid points
+  size_t ngrid(grid.size());
+  vector<double> du(ngrid, 0.0);
+  vector<double> coef(n, 0.0);
+  FDSTATS_COUNT(allocations, 2);
+  FDSTATS_COUNT(points, ngrid);
+
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+  assert(cache.order() == m && cache.points() == n);
+
+  for (size_t i(0); i < ngrid; i++) {
+    size_t start(fdstart(i, n, ngrid));
+    cache.coef(grid[i], &grid[start], coef.data());
+    double sum(0.0);
+    for (unsigned int j(0); j < n; j++)
+      sum = sum + coef[j] * u[start + j];
+    du[i] = sum;
+  }
+
+  return du;
+}
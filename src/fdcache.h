@@ -0,0 +1,57 @@
+#ifndef _fdcache_
+#define _fdcache_
+
+#include <map>
+#include "nufd.h"
+
+// cache of finite difference weights keyed by the local spacing pattern
+//
+// the weights of a stencil only depend on the offsets x[j] - x0 of its
+// nodes, and scaling all the offsets by s scales the weights of the order
+// m derivatives by s^(1-m). on piecewise uniform or geometrically
+// stretched grids most stencils share the same normalized offsets
+// (x[j] - x0) / s, s = x[n-1] - x[0] being the width of the stencil, so
+// the fdcoef recursion only has to run once per distinct pattern.
+//
+// the normalized offsets are quantized with the tolerance tol: stencils
+// whose offsets agree within tol * s reuse the weights of the first
+// stencil seen with that pattern.
+class FdCoefCache {
+ public:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // tol         = quantization of the normalized offsets
+  FdCoefCache(unsigned int m, unsigned int n, double tol = 1e-10);
+
+  // coef[n] = weights of the stencil grid[n] at x0 (same as fdcoef)
+  void coef(double x0, const double *grid, double *coef);
+
+  unsigned int order() const { return m; }
+  unsigned int points() const { return n; }
+
+  // number of stencils found in the cache, computed, and cached patterns
+  size_t hits() const { return nhits; }
+  size_t misses() const { return nmisses; }
+  size_t size() const { return table.size(); }
+
+  void clear();
+
+ private:
+  unsigned int m, n;
+  double tol;
+  size_t nhits, nmisses;
+
+  // normalized weights of every pattern
+  map<vector<long long>, vector<double> > table;
+
+  // buffers reused between the calls
+  vector<long long> key;
+  vector<double> nodes;
+  vector<long double> work;
+};
+
+// fd() with the weights of the cache (serial)
+vector<double> fd(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                  FdCoefCache &cache);
+
+#endif //_fdcache_
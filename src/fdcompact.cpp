@@ -0,0 +1,127 @@
+#include "fdcompact.h"
+#include "fdstats.h"
+
+FdCompactPlan::FdCompactPlan(const FdPlan &plan, FdCompactFormat format)
+    : fmt(format), m(plan.order()), n(plan.points()), ngrid(plan.size()), err(0.0), ref(n * n, 0.0),
+      weights(plan.size() * plan.points()) {
+  // uniform stencils of unit spacing at every position of the grid
+  // point in its stencil (only the central one inside the grid)
+  vector<double> nodes(n);
+  for (unsigned int j(0); j < n; j++)
+    nodes[j] = double(j);
+  vector<long double> work(fdcoef_worksize(m, n));
+  for (unsigned int p(0); p < n; p++)
+    fdcoef(m, n, double(p), nodes.data(), &ref[p * n], work.data());
+
+  if (fmt == FDCOMPACT_DELTA)
+    scales.resize(ngrid);
+
+  vector<double> coef(n);
+  FDSTATS_COUNT(allocations, fmt == FDCOMPACT_DELTA ? 6 : 5);
+  for (size_t i(0); i < ngrid; i++) {
+    assert(plan.offset(i) == fdstart(i, n, ngrid));
+    const double *w(plan.weights(i));
+    float *c(&weights[i * n]);
+
+    if (fmt == FDCOMPACT_FLOAT) {
+      for (unsigned int j(0); j < n; j++)
+        c[j] = float(w[j]);
+    } else {
+      // the scale is the projection of the weights on the uniform ones,
+      // rounded to a float so that only the corrections carry an error
+      const double *r(&ref[(i - plan.offset(i)) * n]);
+      double wr(0.0), rr(0.0);
+      for (unsigned int j(0); j < n; j++) {
+        wr = wr + w[j] * r[j];
+        rr = rr + r[j] * r[j];
+      }
+      float s(rr > 0.0 ? float(wr / rr) : 1.0f);
+      if (s == 0.0f || !std::isfinite(s))
+        s = 1.0f;
+      scales[i] = s;
+      for (unsigned int j(0); j < n; j++)
+        c[j] = float(w[j] / double(s) - r[j]);
+    }
+
+    // error of the decoded stencil relative to the sum of |w|
+    decode(i, coef.data());
+    double num(0.0), den(0.0);
+    for (unsigned int j(0); j < n; j++) {
+      num = num + fabs(coef[j] - w[j]);
+      den = den + fabs(w[j]);
+    }
+    if (den > 0.0)
+      err = max(err, num / den);
+  }
+}
+
+void FdCompactPlan::decode(size_t i, double *coef) const {
+  const float *c(&weights[i * n]);
+  if (fmt == FDCOMPACT_FLOAT) {
+    for (unsigned int j(0); j < n; j++)
+      coef[j] = double(c[j]);
+  } else {
+    const double *r(&ref[(i - fdstart(i, n, ngrid)) * n]);
+    const double s(scales[i]);
+    for (unsigned int j(0); j < n; j++)
+      coef[j] = s * (r[j] + double(c[j]));
+  }
+}
+
+vector<double> FdCompactPlan::apply(const vector<double> &u) const {
+  assert(u.size() == ngrid);
+
+  vector<double> du(ngrid, 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  apply(u.data(), du.data());
+  return du;
+}
+
+void FdCompactPlan::apply(const double *u, double *du) const {
+  // input:
+  // u[ngrid]  = function values at the grid points
+
+  // output:
+  // du[ngrid] = derivative values at the grid points
+  FDSTATS_COUNT(points, ngrid);
+  FDSTATS_TIMER(interior_time);
+  size_t fb((n - 1) / 2), bb(n - 1 - fb);
+  if (fmt == FDCOMPACT_FLOAT) {
+    const float *c(weights.data());
+    for (size_t i(0); i < ngrid; i++, c += n) {
+      const double *ui(u + (i < fb || i + bb >= ngrid ? fdstart(i, n, ngrid) : i - fb));
+      double sum(0.0);
+      for (unsigned int j(0); j < n; j++)
+        sum = sum + double(c[j]) * ui[j];
+      du[i] = sum;
+    }
+    return;
+  }
+
+  // one-sided stencils, each position has its own uniform weights
+  auto boundary = [&](size_t begin, size_t end) {
+    for (size_t i(begin); i < end; i++) {
+      size_t start(fdstart(i, n, ngrid));
+      const float *c(&weights[i * n]);
+      const double *ui(u + start);
+      const double *r(&ref[(i - start) * n]);
+      double sum(0.0);
+      for (unsigned int j(0); j < n; j++)
+        sum = sum + (r[j] + double(c[j])) * ui[j];
+      du[i] = double(scales[i]) * sum;
+    }
+  };
+  boundary(0, fb);
+  boundary(ngrid - bb, ngrid);
+
+  // central stencils share the same uniform weights
+  const double *r(&ref[fb * n]);
+  for (size_t i(fb); i + bb < ngrid; i++) {
+    const float *c(&weights[i * n]);
+    const double *ui(u + i - fb);
+    double sum(0.0);
+    for (unsigned int j(0); j < n; j++)
+      sum = sum + (r[j] + double(c[j])) * ui[j];
+    du[i] = double(scales[i]) * sum;
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef _fdcompact_
+#define _fdcompact_
+
+#include "fdplan.h"
+
+// plan with the weights stored in single precision
+//
+// the weights of an FdPlan take n doubles per grid point (plus the
+// offset of the stencil), several times the size of the field, and the
+// apply sweep is bound by their memory traffic. the compact plan keeps
+// them as floats and accumulates in double, the offsets are recomputed
+// with fdstart.
+//
+// FDCOMPACT_FLOAT   w[j] stored as float (4n bytes per point)
+// FDCOMPACT_DELTA   w[j] = s * (r[j] + d[j]) with r the weights of the
+//                   uniform stencil of unit spacing at the same position,
+//                   s a float scale (the spacing to the power 1-m) and d
+//                   the float correction (4n + 4 bytes per point). on
+//                   smooth grids d is small and so is its rounding error
+//
+// error() is the largest relative error of the decoded stencils measured
+// at construction, sum(|c[j] - w[j]|) / sum(|w[j]|) with c the decoded
+// weights, so that |du - plan.apply(u)| <= error() * sum(|w[j]|) * max(|u[j]|)
+// (up to the rounding of the sums). measured on random grids (spacing
+// ratios up to 3) error() is ~6e-8 for both formats, on smoothly stretched
+// grids it stays ~6e-8 for floats and drops to 1e-10 (500 points) down
+// to 1e-13 (2e6 points) for the deltas.
+enum FdCompactFormat { FDCOMPACT_FLOAT, FDCOMPACT_DELTA };
+
+class FdCompactPlan {
+ public:
+  // weights of plan (any constructor of FdPlan) in the given format
+  FdCompactPlan(const FdPlan &plan, FdCompactFormat format = FDCOMPACT_DELTA);
+
+  // du[ngrid] = derivative of u[ngrid] at the grid points
+  vector<double> apply(const vector<double> &u) const;
+  void apply(const double *u, double *du) const;
+
+  FdCompactFormat format() const { return fmt; }
+  unsigned int order() const { return m; }
+  unsigned int points() const { return n; }
+  size_t size() const { return ngrid; }
+
+  // bound of the relative error of the decoded weights
+  double error() const { return err; }
+
+  // bytes of weights per grid point (FdPlan: n * 8 + 8)
+  double bytes() const { return double((weights.size() + scales.size()) * sizeof(float)) / double(ngrid); }
+
+  // decoded coefficients coef[n] of the stencil at grid point i
+  void decode(size_t i, double *coef) const;
+
+ private:
+  FdCompactFormat fmt;
+  unsigned int m, n;
+  size_t ngrid;
+  double err;
+  vector<double> ref;     // ref[n * n], uniform stencil at each position
+  vector<float> weights;  // weights[ngrid * n], w or d
+  vector<float> scales;   // scales[ngrid], s (delta format)
+};
+
+#endif //_fdcompact_
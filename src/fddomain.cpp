@@ -0,0 +1,206 @@
+#include "fddomain.h"
+#include "fdstats.h"
+
+void FdLocalExchange::send(int from, int to, const double *data, size_t count) {
+  {
+    lock_guard<mutex> guard(lock);
+    mailboxes[make_pair(from, to)].push_back(vector<double>(data, data + count));
+  }
+  arrived.notify_all();
+}
+
+void FdLocalExchange::recv(int from, int to, double *data, size_t count) {
+  unique_lock<mutex> guard(lock);
+  deque<vector<double> > &box(mailboxes[make_pair(from, to)]);
+  arrived.wait(guard, [&box] { return !box.empty(); });
+
+  assert(box.front().size() == count);
+  copy(box.front().begin(), box.front().end(), data);
+  box.pop_front();
+}
+
+void FdLocalTransport::sendrecv(int dest, const double *send, size_t nsend, int source, double *recv,
+                                size_t nrecv) {
+  // sends never block, the message is copied in the mailbox
+  if (dest >= 0)
+    exchange.send(id, dest, send, nsend);
+  if (source >= 0)
+    exchange.recv(source, id, recv, nrecv);
+}
+
+#ifdef NUFD_MPI
+int FdMpiTransport::rank() const {
+  int r;
+  MPI_Comm_rank(comm, &r);
+  return r;
+}
+
+int FdMpiTransport::size() const {
+  int s;
+  MPI_Comm_size(comm, &s);
+  return s;
+}
+
+void FdMpiTransport::sendrecv(int dest, const double *send, size_t nsend, int source, double *recv,
+                              size_t nrecv) {
+  MPI_Sendrecv(const_cast<double *>(send), int(nsend), MPI_DOUBLE, dest < 0 ? MPI_PROC_NULL : dest, 0, recv,
+               int(nrecv), MPI_DOUBLE, source < 0 ? MPI_PROC_NULL : source, 0, comm, MPI_STATUS_IGNORE);
+}
+#endif
+
+vector<size_t> fd_partition(size_t ngrid, int nparts) {
+  // the first ngrid % nparts parts have one more point
+  assert(nparts > 0);
+  vector<size_t> first(nparts + 1, 0);
+  size_t q(ngrid / nparts), r(ngrid % nparts);
+  for (int p(0); p < nparts; p++)
+    first[p + 1] = first[p] + q + (size_t(p) < r ? 1 : 0);
+  return first;
+}
+
+FdDomain::FdDomain(unsigned int m, unsigned int n, const vector<double> &grid, FdTransport &transport)
+    : m(m), n(n), nlocal(grid.size()), gl(0), gr(0), transport(transport), offsets(grid.size()),
+      coefs(grid.size() * n) {
+  // validate the size of the subdomain and number of points
+  // used in the finite difference scheme: the neighbours
+  // need up to n-1 of its points as ghosts
+  assert(n <= nlocal);
+
+  // no ghost at the ends of the global grid
+  int rank(transport.rank()), size(transport.size());
+  if (rank > 0)
+    gl = (n - 1) / 2;
+  if (rank < size - 1)
+    gr = n - 1 - (n - 1) / 2;
+
+  // grid points of the neighbours
+  vector<double> xext(gl + nlocal + gr);
+  copy(grid.begin(), grid.end(), xext.begin() + gl);
+  exchange(xext.data(), 1);
+
+  // central stencils around the cuts, and one-sided stencils at the
+  // ends of the global grid where there is no ghost to use
+  size_t fb((n - 1) / 2), last(xext.size() - n);
+  vector<long double> work(fdcoef_worksize(m, n));
+  FDSTATS_COUNT(allocations, 4);
+  for (size_t i(0); i < nlocal; i++) {
+    offsets[i] = gl + i < fb ? 0 : min(gl + i - fb, last);
+    fdcoef(m, n, xext[gl + i], &xext[offsets[i]], &coefs[i * n], work.data());
+  }
+}
+
+void FdDomain::exchange(double *ext, size_t nfields) {
+  int rank(transport.rank()), size(transport.size());
+  int left(rank > 0 ? rank - 1 : -1), right(rank < size - 1 ? rank + 1 : -1);
+  double *own(ext + gl * nfields);
+
+  // the last points go to the left ghosts of the right neighbour
+  // and the first points to the right ghosts of the left neighbour
+  size_t fb((n - 1) / 2), bb(n - 1 - fb);
+  transport.sendrecv(right, own + (nlocal - fb) * nfields, right < 0 ? 0 : fb * nfields, left, ext,
+                     gl * nfields);
+  transport.sendrecv(left, own, left < 0 ? 0 : bb * nfields, right, own + nlocal * nfields, gr * nfields);
+}
+
+vector<double> FdDomain::apply(const vector<double> &u) {
+  assert(u.size() == nlocal);
+
+  vector<double> du(nlocal, 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  apply(u.data(), du.data());
+  return du;
+}
+
+void FdDomain::apply(const double *u, double *du) {
+  // input:
+  // u[nlocal]  = function values at the local grid points
+
+  // output:
+  // du[nlocal] = derivative values at the local grid points
+  apply(u, du, 1);
+}
+
+vector<double> FdDomain::apply(const vector<double> &u, size_t nfields) {
+  assert(u.size() == nlocal * nfields);
+
+  vector<double> du(nlocal * nfields, 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  apply(u.data(), du.data(), nfields);
+  return du;
+}
+
+void FdDomain::apply(const double *u, double *du, size_t nfields) {
+  // input:
+  // u[nlocal * nfields]  = function values of the fields at the local grid points
+
+  // output:
+  // du[nlocal * nfields] = derivative values of the fields at the local grid points
+  if (ext.capacity() < (gl + nlocal + gr) * nfields) {
+    FDSTATS_COUNT(allocations, 1);
+  }
+  ext.resize((gl + nlocal + gr) * nfields);
+  FDSTATS_COUNT(points, nlocal * nfields);
+  FDSTATS_TIMER(interior_time);
+  copy(u, u + nlocal * nfields, ext.begin() + gl * nfields);
+  exchange(ext.data(), nfields);
+
+  // single field: same sweep as FdPlan::apply so that the sums
+  // are rounded (and contracted) the same way
+  const double *w(coefs.data());
+  if (nfields == 1) {
+    for (size_t i(0); i < nlocal; i++, w += n) {
+      const double *ui(&ext[offsets[i]]);
+      double sum(0.0);
+      for (unsigned int j(0); j < n; j++)
+        sum = sum + w[j] * ui[j];
+      du[i] = sum;
+    }
+    return;
+  }
+
+  for (size_t i(0); i < nlocal; i++, w += n) {
+    const double *ui(&ext[offsets[i] * nfields]);
+    double *dui(du + i * nfields);
+    for (size_t k(0); k < nfields; k++)
+      dui[k] = 0.0;
+    for (unsigned int j(0); j < n; j++) {
+      const double wj(w[j]);
+      const double *uj(ui + j * nfields);
+      for (size_t k(0); k < nfields; k++)
+        dui[k] = dui[k] + wj * uj[k];
+    }
+  }
+}
+
+vector<double> fd_domains(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                          int nparts) {
+  // input:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // grid[ngrid] = array of independent values
+  // u[ngrid]    = function values at the grid points
+  // nparts      = number of subdomains (at least n points each)
+
+  // output:
+  // du[ngrid]   = derivative values at the grid points
+  assert(grid.size() == u.size());
+
+  vector<size_t> first(fd_partition(grid.size(), nparts));
+  vector<double> du(grid.size(), 0.0);
+  FDSTATS_COUNT(allocations, 2 + nparts);
+  FdLocalExchange exchange(nparts);
+
+  auto rank = [&](int r) {
+    FdLocalTransport transport(exchange, r);
+    vector<double> x(grid.begin() + first[r], grid.begin() + first[r + 1]);
+    FdDomain domain(m, n, x, transport);
+    domain.apply(&u[first[r]], &du[first[r]]);
+  };
+
+  vector<thread> workers;
+  for (int r(0); r < nparts; r++)
+    workers.push_back(thread(rank, r));
+  for (size_t t(0); t < workers.size(); t++)
+    workers[t].join();
+  return du;
+}
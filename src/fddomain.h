@@ -0,0 +1,128 @@
+#ifndef _fddomain_
+#define _fddomain_
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include "nufd.h"
+
+// domain decomposition of a grid into contiguous subdomains
+//
+// every rank owns a contiguous part of the global grid and keeps copies of
+// the fb = (n-1)/2 last points of its left neighbour and the bb = n-1-fb
+// first points of its right neighbour (ghost points, one more on the right
+// for even n). the ghost values are exchanged through a transport before
+// every apply, so the stencils of the points next to the cuts are the
+// central ones and the one-sided stencils are only used at the ends of the
+// global grid: the derivatives are the same as fd() on the whole grid.
+
+// point to point exchange between the ranks of a decomposition
+class FdTransport {
+ public:
+  virtual ~FdTransport() {}
+
+  virtual int rank() const = 0;
+  virtual int size() const = 0;
+
+  // sends send[nsend] to rank dest and receives recv[nrecv] from rank
+  // source (-1 = no rank), every rank of the chain calls it together
+  virtual void sendrecv(int dest, const double *send, size_t nsend, int source, double *recv, size_t nrecv) = 0;
+};
+
+// mailboxes shared by the ranks of one process (one thread per rank)
+class FdLocalExchange {
+ public:
+  explicit FdLocalExchange(int nranks) : nranks(nranks) {}
+
+  int size() const { return nranks; }
+
+  // messages from a rank to another are received in the order sent
+  void send(int from, int to, const double *data, size_t count);
+  void recv(int from, int to, double *data, size_t count);
+
+ private:
+  int nranks;
+  mutex lock;
+  condition_variable arrived;
+  map<pair<int, int>, deque<vector<double> > > mailboxes;
+};
+
+// in-process transport of one rank, sends are buffered in the mailboxes
+class FdLocalTransport : public FdTransport {
+ public:
+  FdLocalTransport(FdLocalExchange &exchange, int rank) : exchange(exchange), id(rank) {}
+
+  int rank() const { return id; }
+  int size() const { return exchange.size(); }
+  void sendrecv(int dest, const double *send, size_t nsend, int source, double *recv, size_t nrecv);
+
+ private:
+  FdLocalExchange &exchange;
+  int id;
+};
+
+#ifdef NUFD_MPI
+#include <mpi.h>
+
+// transport over an MPI communicator (cmake -DNUFD_MPI=ON)
+class FdMpiTransport : public FdTransport {
+ public:
+  explicit FdMpiTransport(MPI_Comm comm) : comm(comm) {}
+
+  int rank() const;
+  int size() const;
+  void sendrecv(int dest, const double *send, size_t nsend, int source, double *recv, size_t nrecv);
+
+ private:
+  MPI_Comm comm;
+};
+#endif
+
+// first global index of every part (and ngrid) of a grid of ngrid
+// points split in nparts subdomains of nearly equal size
+vector<size_t> fd_partition(size_t ngrid, int nparts);
+
+// subdomain of the rank of the transport
+class FdDomain {
+ public:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // grid[nlocal] = grid points owned by the rank (at least n), the ranks
+  //                follow each other along the global grid
+  FdDomain(unsigned int m, unsigned int n, const vector<double> &grid, FdTransport &transport);
+
+  // du[nlocal] = derivative of u[nlocal] at the local grid points
+  // (collective, every rank exchanges its ghost values)
+  vector<double> apply(const vector<double> &u);
+  void apply(const double *u, double *du);
+
+  // nfields fields interleaved point by point (u[i * nfields + k]), e.g.
+  // the rows of a 2d array split along its first axis
+  vector<double> apply(const vector<double> &u, size_t nfields);
+  void apply(const double *u, double *du, size_t nfields);
+
+  size_t size() const { return nlocal; }
+  size_t ghosts_left() const { return gl; }
+  size_t ghosts_right() const { return gr; }
+
+ private:
+  // fills the ghost values of ext[(gl + nlocal + gr) * nfields]
+  // from the neighbours
+  void exchange(double *ext, size_t nfields);
+
+  unsigned int m, n;
+  size_t nlocal, gl, gr;
+  FdTransport &transport;
+
+  vector<size_t> offsets; // offsets[nlocal] in ext
+  vector<double> coefs;   // coefs[nlocal * n]
+  vector<double> ext;     // local values with ghosts
+};
+
+// derivative of u[ngrid] computed on nparts subdomains, one thread per
+// rank exchanging its ghost values through an FdLocalExchange
+vector<double> fd_domains(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                          int nparts);
+
+#endif //_fddomain_
@@ -0,0 +1,94 @@
+#ifndef _fdfixed_
+#define _fdfixed_
+
+#include <array>
+#include "nufd.h"
+
+// finite difference schemes with the order of the derivative M
+// (1=value, 2=1st diff, ...) and the number of points N known at
+// compile time. same recursion as fdcoef with all the loops bounded
+// by constants, so the compiler can unroll them and keep the weights
+// in registers.
+
+template <unsigned int M, unsigned int N>
+array<double, N> fdcoef(double x0, const double *grid) {
+  // input:
+  // x0      = point at which to evaluate the coefficients
+  // grid[N] = array containing the grid starting at the lowest bound
+  //           use during finite difference scheme
+
+  // output:
+  // coef[N] = coefficients of the finite difference formula
+  static_assert(M > 0 && N > 0, "fdcoef<M, N> needs M > 0 and N > 0");
+  array<double, N> coef;
+
+  // local variables
+  double c1, c2, c3, c4, alpha;
+  long double weight[M][N];
+
+  // recursive algorithm implementation (see fdweights)
+  weight[0][0] = 1.0;
+  for (unsigned int mm(1); mm < M; mm++)
+    weight[mm][0] = 0.0;
+
+  c1 = 1.0;
+  for (unsigned int nn(1); nn < N; nn++) {
+    c2 = 1.0;
+    for (unsigned int nu(0); nu < nn; nu++) {
+      c3 = grid[nn] - grid[nu];
+      c2 = c2 * c3;
+
+      if (nu == nn - 1) {
+        alpha = grid[nn - 1] - x0;
+        c4 = c1 / c2;
+        for (unsigned int mm(M - 1); mm > 0; mm--)
+          weight[mm][nn] = c4 * (int(mm) * weight[mm - 1][nn - 1] - alpha * weight[mm][nn - 1]);
+        weight[0][nn] = c4 * (-alpha * weight[0][nn - 1]);
+      }
+
+      c4 = 1.0 / c3;
+      alpha = grid[nn] - x0;
+      for (unsigned int mm(M - 1); mm > 0; mm--)
+        weight[mm][nu] = c4 * (alpha * weight[mm][nu] - int(mm) * weight[mm - 1][nu]);
+      weight[0][nu] = c4 * (alpha * weight[0][nu]);
+    }
+    c1 = c2;
+  }
+
+  // load the coefficients
+  for (unsigned int nu(0); nu < N; nu++)
+    coef[nu] = double(weight[M - 1][nu]);
+
+  return coef;
+}
+
+template <unsigned int M, unsigned int N>
+vector<double> fd(const vector<double> &grid, const vector<double> &u) {
+  // input:
+  // grid[ngrid] = array of independent values
+  // u[ngrid]    = function values at the grid points
+
+  // output:
+  // du[ngrid]   = derivative values at the grid points
+  size_t ngrid(grid.size());
+  vector<double> du(ngrid, 0.0);
+
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(N <= ngrid);
+
+  for (size_t i(0); i < ngrid; i++) {
+    size_t start(fdstart(i, N, ngrid));
+    array<double, N> coef = fdcoef<M, N>(grid[i], &grid[start]);
+
+    const double *ui(&u[start]);
+    double sum(0.0);
+    for (unsigned int j(0); j < N; j++)
+      sum = sum + coef[j] * ui[j];
+    du[i] = sum;
+  }
+
+  return du;
+}
+
+#endif //_fdfixed_
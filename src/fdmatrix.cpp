@@ -0,0 +1,154 @@
+#include "fdmatrix.h"
+
+FdBandMatrix fd_band(const FdPlan &plan) {
+  size_t ngrid(plan.size());
+  unsigned int n(plan.points());
+
+  // bandwidths of the stencils, the forward and
+  // backward rows are wider than the central ones
+  FdBandMatrix a;
+  a.n = ngrid;
+  a.kl = 0;
+  a.ku = 0;
+  for (size_t i(0); i < ngrid; i++) {
+    a.kl = max(a.kl, i - plan.offset(i));
+    a.ku = max(a.ku, plan.offset(i) + n - 1 - i);
+  }
+  a.cl = (n - 1) / 2;
+  a.cu = n - 1 - a.cl;
+
+  a.ab.assign(ngrid * (a.kl + a.ku + 1), 0.0);
+  for (size_t i(0); i < ngrid; i++) {
+    const double *w(plan.weights(i));
+    for (unsigned int j(0); j < n; j++)
+      a(i, plan.offset(i) + j) = w[j];
+  }
+  return a;
+}
+
+FdCsrMatrix fd_csr(const FdPlan &plan) {
+  size_t ngrid(plan.size());
+  unsigned int n(plan.points());
+
+  FdCsrMatrix a;
+  a.n = ngrid;
+  a.rowptr.resize(ngrid + 1);
+  a.col.resize(ngrid * n);
+  a.val.resize(ngrid * n);
+  for (size_t i(0); i < ngrid; i++) {
+    a.rowptr[i] = i * n;
+    const double *w(plan.weights(i));
+    for (unsigned int j(0); j < n; j++) {
+      a.col[i * n + j] = plan.offset(i) + j;
+      a.val[i * n + j] = w[j];
+    }
+  }
+  a.rowptr[ngrid] = ngrid * n;
+  return a;
+}
+
+void band_mult(const FdBandMatrix &a, const double *x, double *y) {
+  size_t w(a.kl + a.ku + 1), nc(a.cl + a.cu + 1);
+  size_t ib(min(a.cl, a.n)), ie(max(ib, a.n - min(a.cu, a.n)));
+
+  // forward and backward rows over the whole band,
+  // only the columns of the row inside the matrix
+  auto edge = [&](size_t begin, size_t end) {
+    for (size_t i(begin); i < end; i++) {
+      size_t jb(i < a.kl ? a.kl - i : 0);
+      size_t je(min(w, a.n + a.kl - i));
+      const double *ai(&a.ab[i * w + jb]);
+      const double *xi(x + jb + i - a.kl);
+      double sum(0.0);
+      for (size_t d(0); d < je - jb; d++)
+        sum = sum + ai[d] * xi[d];
+      y[i] = sum;
+    }
+  };
+  edge(0, ib);
+  edge(ie, a.n);
+
+  // central rows over their own diagonals
+  for (size_t i(ib); i < ie; i++) {
+    const double *ai(&a.ab[i * w + a.kl - a.cl]);
+    const double *xi(x + i - a.cl);
+    double sum(0.0);
+    for (size_t d(0); d < nc; d++)
+      sum = sum + ai[d] * xi[d];
+    y[i] = sum;
+  }
+}
+
+void csr_mult(const FdCsrMatrix &a, const double *x, double *y) {
+  for (size_t i(0); i < a.n; i++) {
+    double sum(0.0);
+    for (size_t k(a.rowptr[i]); k < a.rowptr[i + 1]; k++)
+      sum = sum + a.val[k] * x[a.col[k]];
+    y[i] = sum;
+  }
+}
+
+bool band_lu(const FdBandMatrix &a, FdBandLU &f) {
+  size_t n(a.n), kl(a.kl), ku(a.ku);
+  size_t w(2 * kl + ku + 1);
+  f.n = n;
+  f.kl = kl;
+  f.ku = ku;
+  f.lu.assign(n * w, 0.0);
+  f.piv.resize(n);
+
+  // element (i, j) of the factorization
+  auto lu = [&](size_t i, size_t j) -> double & { return f.lu[i * w + j + kl - i]; };
+
+  for (size_t i(0); i < n; i++)
+    for (size_t j(i < kl ? 0 : i - kl); j <= min(n - 1, i + ku); j++)
+      lu(i, j) = a(i, j);
+
+  for (size_t k(0); k < n; k++) {
+    size_t last(min(n - 1, k + kl));
+    size_t lastc(min(n - 1, k + kl + ku));
+
+    // partial pivoting among the kl rows below the diagonal
+    size_t p(k);
+    for (size_t r(k + 1); r <= last; r++)
+      if (fabs(lu(r, k)) > fabs(lu(p, k)))
+        p = r;
+    f.piv[k] = p;
+    if (lu(p, k) == 0.0)
+      return false;
+    if (p != k)
+      for (size_t j(k); j <= lastc; j++)
+        swap(lu(k, j), lu(p, j));
+
+    // elimination, the multipliers are stored below the diagonal
+    for (size_t r(k + 1); r <= last; r++) {
+      double l(lu(r, k) / lu(k, k));
+      lu(r, k) = l;
+      if (l != 0.0)
+        for (size_t j(k + 1); j <= lastc; j++)
+          lu(r, j) = lu(r, j) - l * lu(k, j);
+    }
+  }
+  return true;
+}
+
+void band_solve(const FdBandLU &f, double *b) {
+  size_t n(f.n), kl(f.kl), ku(f.ku);
+  size_t w(2 * kl + ku + 1);
+  auto lu = [&](size_t i, size_t j) { return f.lu[i * w + j + kl - i]; };
+
+  // forward substitution with the row interchanges
+  for (size_t k(0); k < n; k++) {
+    swap(b[k], b[f.piv[k]]);
+    for (size_t r(k + 1); r <= min(n - 1, k + kl); r++)
+      b[r] = b[r] - lu(r, k) * b[k];
+  }
+
+  // back substitution
+  for (size_t k(n); k-- > 0;) {
+    double sum(b[k]);
+    for (size_t j(k + 1); j <= min(n - 1, k + kl + ku); j++)
+      sum = sum - lu(k, j) * b[j];
+    b[k] = sum / lu(k, k);
+  }
+}
@@ -0,0 +1,56 @@
+#ifndef _fdmatrix_
+#define _fdmatrix_
+
+#include "fdplan.h"
+
+// differentiation operator of a plan as a ngrid x ngrid sparse matrix
+//
+// row i holds the weights of the stencil of grid point i (forward and
+// backward rows included), so that D u = fd(m, n, grid, u). the matrices
+// can be assembled once and reused, e.g. in the jacobians of implicit
+// time steppers.
+
+// banded matrix with kl sub-diagonals and ku super-diagonals, stored by
+// rows: a(i, j) = ab[i * (kl + ku + 1) + j - i + kl] for -kl <= j - i <= ku.
+// the rows cl <= i < n - cu only have entries for -cl <= j - i <= cu (the
+// central stencils, cl = kl and cu = ku if all the rows are alike)
+struct FdBandMatrix {
+  size_t n, kl, ku, cl, cu;
+  vector<double> ab;
+
+  double &operator()(size_t i, size_t j) { return ab[i * (kl + ku + 1) + j + kl - i]; }
+  double operator()(size_t i, size_t j) const { return ab[i * (kl + ku + 1) + j + kl - i]; }
+};
+
+// compressed sparse rows
+struct FdCsrMatrix {
+  size_t n;
+  vector<size_t> rowptr; // rowptr[n + 1]
+  vector<size_t> col;
+  vector<double> val;
+};
+
+// LU factorization with partial pivoting of a banded matrix (LAPACK gbtrf
+// scheme), the fill-in needs kl more super-diagonals:
+// lu(i, j) = lu[i * (2 kl + ku + 1) + j - i + kl] for -kl <= j - i <= kl + ku
+struct FdBandLU {
+  size_t n, kl, ku;
+  vector<double> lu;
+  vector<size_t> piv;
+};
+
+FdBandMatrix fd_band(const FdPlan &plan);
+FdCsrMatrix fd_csr(const FdPlan &plan);
+
+// y[n] = a x[n]
+void band_mult(const FdBandMatrix &a, const double *x, double *y);
+void csr_mult(const FdCsrMatrix &a, const double *x, double *y);
+
+// factorization of a and solution of a x = b in place of b[n]. band_lu
+// only returns false on an exactly zero pivot: a numerically singular a
+// (e.g. a derivative operator, the constants are in its kernel) gives a
+// tiny pivot and a meaningless solution
+bool band_lu(const FdBandMatrix &a, FdBandLU &f);
+void band_solve(const FdBandLU &f, double *b);
+
+#endif //_fdmatrix_
@@ -0,0 +1,94 @@
+#include "fdnd.h"
+#include "fdstats.h"
+
+// number of contiguous values processed at once along the
+// inner dimensions: the n rows used by a stencil stay in cache
+#define FDND_BLOCK 512
+
+void fd_axis(const FdPlan &plan, const vector<size_t> &shape, size_t axis, const double *u, double *du) {
+  // input:
+  // plan          = stencils of the grid of the differentiated axis
+  // shape[ndim]   = dimensions of the array
+  // axis          = differentiated axis
+  // u[prod(shape)] = function values at the grid points
+
+  // output:
+  // du[prod(shape)] = derivative values at the grid points
+  assert(axis < shape.size());
+  assert(plan.size() == shape[axis]);
+
+  // the array is seen as outer x len x inner
+  size_t len(shape[axis]), outer(1), inner(1);
+  for (size_t d(0); d < axis; d++)
+    outer = outer * shape[d];
+  for (size_t d(axis + 1); d < shape.size(); d++)
+    inner = inner * shape[d];
+
+  // a slab (len x inner values) is computed in a buffer
+  // before being copied back when working in place
+  vector<double> slab;
+  if (u == du) {
+    slab.resize(len * inner);
+    FDSTATS_COUNT(allocations, 1);
+  }
+
+  unsigned int n(plan.points());
+  for (size_t o(0); o < outer; o++) {
+    const double *uo(u + o * len * inner);
+    double *out(u == du ? slab.data() : du + o * len * inner);
+
+    if (inner == 1) {
+      // contiguous pencil
+      plan.apply(uo, out);
+    } else {
+      // the weights of a point are applied to a block of pencils
+      FDSTATS_COUNT(points, len * inner);
+      FDSTATS_TIMER(interior_time);
+      for (size_t kb(0); kb < inner; kb += FDND_BLOCK) {
+        size_t ke(min(kb + FDND_BLOCK, inner));
+        for (size_t i(0); i < len; i++) {
+          const double *w(plan.weights(i));
+          const double *ui(uo + plan.offset(i) * inner);
+          double *outi(out + i * inner);
+          for (size_t k(kb); k < ke; k++)
+            outi[k] = 0.0;
+          for (unsigned int j(0); j < n; j++) {
+            const double wj(w[j]);
+            const double *uj(ui + j * inner);
+            for (size_t k(kb); k < ke; k++)
+              outi[k] = outi[k] + wj * uj[k];
+          }
+        }
+      }
+    }
+
+    if (u == du)
+      copy(slab.begin(), slab.end(), du + o * len * inner);
+  }
+}
+
+vector<double> fd_axis(unsigned int m, unsigned int n, const vector<double> &grid, const vector<size_t> &shape,
+                       size_t axis, const vector<double> &u) {
+  // input:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // grid[shape[axis]] = array of independent values along axis
+  // shape[ndim] = dimensions of the array
+  // axis        = differentiated axis
+  // u[prod(shape)] = function values at the grid points
+
+  // output:
+  // du[prod(shape)] = derivative values at the grid points
+  vector<double> du(u.size(), 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  fd_axis(FdPlan(m, n, grid), shape, axis, u.data(), du.data());
+  return du;
+}
+
+void fd_mixed(const FdPlan &plan_a, size_t axis_a, const FdPlan &plan_b, size_t axis_b,
+              const vector<size_t> &shape, const double *u, double *du) {
+  // derivative along axis_a in du, then along axis_b in place
+  assert(axis_a != axis_b);
+  fd_axis(plan_a, shape, axis_a, u, du);
+  fd_axis(plan_b, shape, axis_b, du, du);
+}
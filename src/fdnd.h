@@ -0,0 +1,21 @@
+#ifndef _fdnd_
+#define _fdnd_
+
+#include "fdplan.h"
+
+// derivatives along one axis of a rectilinear grid
+//
+// u is a row-major array of dimensions shape[0] x shape[1] x ... (the
+// last index is contiguous) and every axis has its own non-uniform grid.
+// the plan of the differentiated axis is built once (plan.size() must be
+// shape[axis]) and its weights are reused for all the pencils. u and du
+// may be the same array to differentiate in place.
+void fd_axis(const FdPlan &plan, const vector<size_t> &shape, size_t axis, const double *u, double *du);
+vector<double> fd_axis(unsigned int m, unsigned int n, const vector<double> &grid, const vector<size_t> &shape,
+                       size_t axis, const vector<double> &u);
+
+// mixed derivatives (e.g. d2/dxdy) computed along axis a then along axis b
+void fd_mixed(const FdPlan &plan_a, size_t axis_a, const FdPlan &plan_b, size_t axis_b,
+              const vector<size_t> &shape, const double *u, double *du);
+
+#endif //_fdnd_
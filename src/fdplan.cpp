@@ -0,0 +1,169 @@
+#include "fdplan.h"
+#include "fdcache.h"
+#include "fdstats.h"
+
+FdPlan::FdPlan(unsigned int m, unsigned int n, const vector<double> &grid)
+    : m(m), n(n), ngrid(grid.size()), offsets(grid.size()), coefs(grid.size() * n) {
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+
+  // compute and store the stencil of every grid point
+  vector<long double> work(fdcoef_worksize(m, n));
+  FDSTATS_COUNT(allocations, 3);
+  for (size_t i(0); i < ngrid; i++) {
+    offsets[i] = fdstart(i, n, ngrid);
+    fdcoef(m, n, grid[i], &grid[offsets[i]], &coefs[i * n], work.data());
+  }
+}
+
+FdPlan::FdPlan(unsigned int m, unsigned int n, const vector<double> &grid, FdCoefCache &cache)
+    : m(m), n(n), ngrid(grid.size()), offsets(grid.size()), coefs(grid.size() * n) {
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+  assert(cache.order() == m && cache.points() == n);
+
+  FDSTATS_COUNT(allocations, 2);
+  for (size_t i(0); i < ngrid; i++) {
+    offsets[i] = fdstart(i, n, ngrid);
+    cache.coef(grid[i], &grid[offsets[i]], &coefs[i * n]);
+  }
+}
+
+FdPlan::FdPlan(unsigned int n, const vector<double> &grid, const vector<vector<double> > &c)
+    : m(c.size()), n(n), ngrid(grid.size()), offsets(grid.size()), coefs(grid.size() * n) {
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+  assert(m > 0);
+  for (unsigned int k(0); k < m; k++)
+    assert(c[k].size() == ngrid);
+
+  // weights of all the orders at a grid point
+  vector<double> all(m * n, 0.0);
+  vector<long double> work(fdcoef_worksize(m, n));
+  FDSTATS_COUNT(allocations, 4);
+  for (size_t i(0); i < ngrid; i++) {
+    offsets[i] = fdstart(i, n, ngrid);
+    fdcoef_all(m, n, grid[i], &grid[offsets[i]], all.data(), work.data());
+    fdcombine(m, n, c, i, all.data(), &coefs[i * n]);
+  }
+}
+
+vector<double> FdPlan::apply(const vector<double> &u) const {
+  assert(u.size() == ngrid);
+
+  vector<double> du(ngrid, 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  apply(u.data(), du.data());
+  return du;
+}
+
+void FdPlan::apply(const double *u, double *du) const {
+  // input:
+  // u[ngrid]  = function values at the grid points
+
+  // output:
+  // du[ngrid] = derivative values at the grid points
+  FDSTATS_COUNT(points, ngrid);
+  FDSTATS_TIMER(interior_time);
+  const double *w(coefs.data());
+  for (size_t i(0); i < ngrid; i++, w += n) {
+    const double *ui(u + offsets[i]);
+    double sum(0.0);
+    for (unsigned int j(0); j < n; j++)
+      sum = sum + w[j] * ui[j];
+    du[i] = sum;
+  }
+}
+
+vector<double> FdPlan::apply(const vector<double> &u, size_t nfields) const {
+  assert(u.size() == ngrid * nfields);
+
+  vector<double> du(ngrid * nfields, 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  apply(u.data(), du.data(), nfields);
+  return du;
+}
+
+void FdPlan::apply(const double *u, double *du, size_t nfields) const {
+  // input:
+  // u[ngrid * nfields]  = function values of the fields at the grid points
+
+  // output:
+  // du[ngrid * nfields] = derivative values of the fields at the grid points
+  FDSTATS_COUNT(points, ngrid * nfields);
+  FDSTATS_TIMER(interior_time);
+  const double *w(coefs.data());
+  for (size_t i(0); i < ngrid; i++, w += n) {
+    const double *ui(u + offsets[i] * nfields);
+    double *dui(du + i * nfields);
+    for (size_t k(0); k < nfields; k++)
+      dui[k] = 0.0;
+
+    // contiguous inner loop over the fields (vectorized)
+    for (unsigned int j(0); j < n; j++) {
+      const double wj(w[j]);
+      const double *uj(ui + j * nfields);
+      for (size_t k(0); k < nfields; k++)
+        dui[k] = dui[k] + wj * uj[k];
+    }
+  }
+}
+
+vector<double> FdPlan::apply_transpose(const vector<double> &v) const {
+  assert(v.size() == ngrid);
+
+  vector<double> dtv(ngrid, 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  apply_transpose(v.data(), dtv.data());
+  return dtv;
+}
+
+void FdPlan::apply_transpose(const double *v, double *dtv) const {
+  // input:
+  // v[ngrid]   = values at the grid points
+
+  // output:
+  // dtv[ngrid] = D^T v
+  FDSTATS_COUNT(points, ngrid);
+  FDSTATS_TIMER(interior_time);
+  for (size_t i(0); i < ngrid; i++)
+    dtv[i] = 0.0;
+
+  const double *w(coefs.data());
+  for (size_t i(0); i < ngrid; i++, w += n) {
+    double *di(dtv + offsets[i]);
+    const double vi(v[i]);
+    for (unsigned int j(0); j < n; j++)
+      di[j] = di[j] + w[j] * vi;
+  }
+}
+
+void FdPlan::apply_both(const double *u, double *du, const double *v, double *dtv) const {
+  // input:
+  // u[ngrid]   = function values at the grid points
+  // v[ngrid]   = values at the grid points
+
+  // output:
+  // du[ngrid]  = D u
+  // dtv[ngrid] = D^T v
+  FDSTATS_COUNT(points, 2 * ngrid);
+  FDSTATS_TIMER(interior_time);
+  for (size_t i(0); i < ngrid; i++)
+    dtv[i] = 0.0;
+
+  const double *w(coefs.data());
+  for (size_t i(0); i < ngrid; i++, w += n) {
+    const double *ui(u + offsets[i]);
+    double *di(dtv + offsets[i]);
+    const double vi(v[i]);
+    double sum(0.0);
+    for (unsigned int j(0); j < n; j++) {
+      sum = sum + w[j] * ui[j];
+      di[j] = di[j] + w[j] * vi;
+    }
+    du[i] = sum;
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef _fdplan_
+#define _fdplan_
+
+#include "nufd.h"
+
+class FdCoefCache;
+
+// finite difference plan built once for a fixed grid
+//
+// the coefficients of the n points stencil of every grid point
+// are computed with fdcoef at construction and stored contiguously
+// (point by point) with the first grid index used by each stencil.
+// apply() is then only a multiply-add sweep over the function values
+// and can be reused for any number of fields defined on the same grid.
+class FdPlan {
+ public:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // grid[ngrid] = array of independent values
+  FdPlan(unsigned int m, unsigned int n, const vector<double> &grid);
+
+  // same plan with the weights taken from a cache of spacing patterns
+  // (see fdcache.h), the cache must have the same m and n
+  FdPlan(unsigned int m, unsigned int n, const vector<double> &grid, FdCoefCache &cache);
+
+  // plan of the linear operator L u = sum(c[k][i] * d^k u / dx^k, k = 0..m-1)
+  // with the m coefficient fields c[k][ngrid], the weights of all the
+  // orders are combined in a single stencil per grid point
+  FdPlan(unsigned int n, const vector<double> &grid, const vector<vector<double> > &c);
+
+  // du[ngrid] = derivative of u[ngrid] at the grid points
+  vector<double> apply(const vector<double> &u) const;
+  void apply(const double *u, double *du) const;
+
+  // nfields fields interleaved point by point, u[i * nfields + k] being
+  // the value of field k at grid point i (same layout for du). the
+  // weights of a stencil are loaded once for all the fields
+  vector<double> apply(const vector<double> &u, size_t nfields) const;
+  void apply(const double *u, double *du, size_t nfields) const;
+
+  // dtv[ngrid] = transpose of the operator applied to v[ngrid] (adjoint),
+  // each point scatters its weights to the points of its stencil
+  vector<double> apply_transpose(const vector<double> &v) const;
+  void apply_transpose(const double *v, double *dtv) const;
+
+  // du = D u and dtv = D^T v in a single sweep over the weights
+  void apply_both(const double *u, double *du, const double *v, double *dtv) const;
+
+  unsigned int order() const { return m; }
+  unsigned int points() const { return n; }
+  size_t size() const { return ngrid; }
+
+  // first grid index and coefficients of the stencil at grid point i
+  size_t offset(size_t i) const { return offsets[i]; }
+  const double *weights(size_t i) const { return &coefs[i * n]; }
+
+ private:
+  unsigned int m, n;
+  size_t ngrid;
+  vector<size_t> offsets; // offsets[ngrid]
+  vector<double> coefs;   // coefs[ngrid * n]
+};
+
+#endif //_fdplan_
@@ -0,0 +1,37 @@
+#include "fdstats.h"
+
+#ifdef NUFD_STATS
+
+std::atomic<uint64_t> fdstats_fdcoef_calls(0), fdstats_points(0), fdstats_allocations(0);
+std::atomic<uint64_t> fdstats_coef_time(0), fdstats_boundary_time(0), fdstats_interior_time(0);
+
+FdStats fd_stats() {
+  FdStats stats;
+  stats.fdcoef_calls = fdstats_fdcoef_calls;
+  stats.points = fdstats_points;
+  stats.allocations = fdstats_allocations;
+  stats.coef_time = 1e-9 * double(fdstats_coef_time);
+  stats.boundary_time = 1e-9 * double(fdstats_boundary_time);
+  stats.interior_time = 1e-9 * double(fdstats_interior_time);
+  return stats;
+}
+
+void fd_stats_reset() {
+  fdstats_fdcoef_calls = 0;
+  fdstats_points = 0;
+  fdstats_allocations = 0;
+  fdstats_coef_time = 0;
+  fdstats_boundary_time = 0;
+  fdstats_interior_time = 0;
+}
+
+#else
+
+FdStats fd_stats() {
+  FdStats stats = {0, 0, 0, 0.0, 0.0, 0.0};
+  return stats;
+}
+
+void fd_stats_reset() {}
+
+#endif
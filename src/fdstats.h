@@ -0,0 +1,68 @@
+#ifndef _fdstats_
+#define _fdstats_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// instrumentation of the hot paths, compiled only with NUFD_STATS defined
+// (cmake -DNUFD_STATS=ON), otherwise the macros below are empty and
+// fd_stats() always returns zeros.
+//
+// points and allocations are counted by the entry points of nufd.h (fd,
+// fd_uniform, fd_all, fd_batch, fd_eval*, fd_op, fd_periodic, fd_integral),
+// FdPlan, FdCompactPlan, FdCoefCache, FdStream, FdWindow, fd_axis and
+// FdDomain. the matrix exports of fdmatrix.h and the header-only templates
+// of fdtyped.h and fdfixed.h are not instrumented, and the growth of the
+// vectors owned by the caller (e.g. du of FdStream::push) is not counted.
+//
+// the phase times are summed over the threads (each worker of fd() and
+// fd_integral times its own chunk), so with several threads they exceed
+// the wall time. coef_time (weight recursions) is included in
+// boundary_time (forward and backward stencils of fd()) and interior_time
+// (central stencils of fd(), plan sweeps, fd_integral chunks and the
+// exchange and sweep of FdDomain::apply).
+struct FdStats {
+  uint64_t fdcoef_calls; // weight recursions
+  uint64_t points;       // derivative values computed (points x fields)
+  uint64_t allocations;  // buffers allocated
+  double coef_time;      // seconds
+  double boundary_time;  // seconds
+  double interior_time;  // seconds
+};
+
+// snapshot of the counters since the start or the last reset
+FdStats fd_stats();
+void fd_stats_reset();
+
+#ifdef NUFD_STATS
+
+extern std::atomic<uint64_t> fdstats_fdcoef_calls, fdstats_points, fdstats_allocations;
+extern std::atomic<uint64_t> fdstats_coef_time, fdstats_boundary_time, fdstats_interior_time;
+
+// adds the lifetime of the timer (in ns) to a counter
+class FdStatsTimer {
+ public:
+  explicit FdStatsTimer(std::atomic<uint64_t> &counter)
+      : counter(counter), start(std::chrono::steady_clock::now()) {}
+  ~FdStatsTimer() {
+    counter += uint64_t(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+
+ private:
+  std::atomic<uint64_t> &counter;
+  std::chrono::steady_clock::time_point start;
+};
+
+#define FDSTATS_COUNT(field, count) (fdstats_##field += uint64_t(count))
+#define FDSTATS_TIMER(field) FdStatsTimer fdstats_timer_##field(fdstats_##field)
+
+#else
+
+#define FDSTATS_COUNT(field, count)
+#define FDSTATS_TIMER(field)
+
+#endif
+
+#endif //_fdstats_
@@ -0,0 +1,64 @@
+#include "fdstream.h"
+#include "fdstats.h"
+
+FdStream::FdStream(unsigned int m, unsigned int n)
+    : m(m), n(n), fb((n - 1) / 2), bb(n - 1 - (n - 1) / 2), total(0), done(0), first(0), coef(n, 0.0),
+      work(fdcoef_worksize(m, n)) {
+  xbuf.reserve(2 * n);
+  ubuf.reserve(2 * n);
+  FDSTATS_COUNT(allocations, 4);
+}
+
+void FdStream::emit(size_t start, vector<double> &du) {
+  // derivative of point done with the stencil starting at start
+  const double *x(&xbuf[start - first]);
+  const double *u(&ubuf[start - first]);
+  fdcoef(m, n, xbuf[done - first], x, coef.data(), work.data());
+
+  double sum(0.0);
+  for (int j(0); j < n; j++)
+    sum = sum + coef[j] * u[j];
+  du.push_back(sum);
+  done++;
+  FDSTATS_COUNT(points, 1);
+}
+
+void FdStream::push(const double *x, const double *u, size_t count, vector<double> &du) {
+  xbuf.insert(xbuf.end(), x, x + count);
+  ubuf.insert(ubuf.end(), u, u + count);
+  total += count;
+
+  // forward stencils need the first n points and central
+  // stencils the bb points following the current point
+  while (done < total && (done < fb ? total >= n : done + bb < total))
+    emit(done < fb ? 0 : done - fb, du);
+
+  // keep the points of the next central stencil and the
+  // last n points for the backward stencils
+  size_t keep(done < fb ? 0 : done - fb);
+  if (total >= n)
+    keep = min(keep, total - n);
+  else
+    keep = 0;
+
+  if (keep > first) {
+    xbuf.erase(xbuf.begin(), xbuf.begin() + (keep - first));
+    ubuf.erase(ubuf.begin(), ubuf.begin() + (keep - first));
+    first = keep;
+  }
+}
+
+void FdStream::push(const vector<double> &x, const vector<double> &u, vector<double> &du) {
+  assert(x.size() == u.size());
+  push(x.data(), u.data(), x.size(), du);
+}
+
+void FdStream::finish(vector<double> &du) {
+  // validate the size of the series and number of points
+  // used in the finite difference scheme
+  assert(n <= total);
+
+  // backward stencils at the end of the series
+  while (done < total)
+    emit(fdstart(done, n, total), du);
+}
@@ -0,0 +1,47 @@
+#ifndef _fdstream_
+#define _fdstream_
+
+#include "nufd.h"
+
+// streaming finite difference engine for series larger than memory
+//
+// chunks of (x, u) are pushed in order and the derivatives are appended
+// to the output as soon as their stencil is complete. only the last
+// points needed by the next stencils are kept between chunks, so the
+// memory does not depend on the length of the series. the forward and
+// backward stencils are only used at the start and at the end (finish)
+// of the stream and the values are the same as fd() on the whole series.
+class FdStream {
+ public:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  FdStream(unsigned int m, unsigned int n);
+
+  // x[count], u[count] = next grid points and function values,
+  // the derivatives that become final are appended to du
+  void push(const double *x, const double *u, size_t count, vector<double> &du);
+  void push(const vector<double> &x, const vector<double> &u, vector<double> &du);
+
+  // end of the stream, the remaining derivatives are appended to du
+  void finish(vector<double> &du);
+
+  // number of points received and number of derivatives emitted
+  size_t received() const { return total; }
+  size_t emitted() const { return done; }
+
+ private:
+  void emit(size_t start, vector<double> &du);
+
+  unsigned int m, n;
+  size_t fb, bb;
+  size_t total, done;
+
+  // points of global index first..total-1
+  size_t first;
+  vector<double> xbuf, ubuf;
+
+  vector<double> coef;
+  vector<long double> work;
+};
+
+#endif //_fdstream_
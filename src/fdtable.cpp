@@ -0,0 +1,22 @@
+#include "fdtable.h"
+
+// walk through all the tabulated pairs (m, n) with n >= m
+template <unsigned int M, unsigned int N>
+struct fdtable_lookup {
+  static const double *find(unsigned int m, unsigned int n) {
+    if (m == M && n == N)
+      return fdtable<M, N>::weights;
+    return fdtable_lookup<(N < FDTABLE_NMAX ? M : M + 1), (N < FDTABLE_NMAX ? N + 1 : M + 1)>::find(m, n);
+  }
+};
+
+template <unsigned int N>
+struct fdtable_lookup<FDTABLE_MMAX + 1, N> {
+  static const double *find(unsigned int, unsigned int) { return nullptr; }
+};
+
+const double *fdtable_weights(unsigned int m, unsigned int n) {
+  if (m < 1 || m > FDTABLE_MMAX || n < m || n > FDTABLE_NMAX)
+    return nullptr;
+  return fdtable_lookup<1, 1>::find(m, n);
+}
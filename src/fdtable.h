@@ -0,0 +1,54 @@
+#ifndef _fdtable_
+#define _fdtable_
+
+#include <cstddef>
+
+// compile-time finite difference coefficients on uniform grids
+//
+// fdtable<m, n>::weights[p * n + j] is the weight of node j of the n points
+// stencil x = 0, 1, ..., n-1 for the derivative m-1 (1=value, 2=1st diff, ...)
+// evaluated at node p. the weights are given for a unit spacing: on a grid of
+// spacing h they are scaled by h^(1-m).
+
+// recursion of fdcoef for integer nodes 0..nn evaluated by the compiler,
+// weight of node nu for the derivative of order mm at x0
+constexpr long double fdtable_weight(int mm, int nn, int nu, long double x0) {
+  return (mm < 0 || nu > nn) ? 0.0L :
+         nn == 0 ? (mm == 0 ? 1.0L : 0.0L) :
+         nu < nn ? ((nn - x0) * fdtable_weight(mm, nn - 1, nu, x0) - mm * fdtable_weight(mm - 1, nn - 1, nu, x0)) /
+                   (nn - nu) :
+         (mm * fdtable_weight(mm - 1, nn - 1, nn - 1, x0) - (nn - 1 - x0) * fdtable_weight(mm, nn - 1, nn - 1, x0)) / nn;
+}
+
+// 0, 1, ..., n-1 as a parameter pack
+template <size_t... Is>
+struct fdtable_indices {};
+
+template <size_t N, size_t... Is>
+struct fdtable_make_indices : fdtable_make_indices<N - 1, N - 1, Is...> {};
+
+template <size_t... Is>
+struct fdtable_make_indices<0, Is...> {
+  typedef fdtable_indices<Is...> type;
+};
+
+template <unsigned int M, unsigned int N, typename I = typename fdtable_make_indices<N * N>::type>
+struct fdtable;
+
+template <unsigned int M, unsigned int N, size_t... Is>
+struct fdtable<M, N, fdtable_indices<Is...> > {
+  static constexpr double weights[N * N] = {double(fdtable_weight(M - 1, N - 1, Is % N, Is / N))...};
+};
+
+template <unsigned int M, unsigned int N, size_t... Is>
+constexpr double fdtable<M, N, fdtable_indices<Is...> >::weights[N * N];
+
+// largest tabulated m and n
+#define FDTABLE_MMAX 5
+#define FDTABLE_NMAX 9
+
+// weights of fdtable<m, n> for m <= FDTABLE_MMAX and m <= n <= FDTABLE_NMAX,
+// a null pointer for the other pairs
+const double *fdtable_weights(unsigned int m, unsigned int n);
+
+#endif //_fdtable_
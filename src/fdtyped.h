@@ -0,0 +1,138 @@
+#ifndef _fdtyped_
+#define _fdtyped_
+
+#include "nufd.h"
+
+// finite difference schemes templated on the storage type T of the grid,
+// function and derivative values and on the type W used to compute the
+// weights, e.g. float storage (twice the simd width and half the memory
+// traffic of double) with double weight generation. the non-template
+// functions of nufd.h (double storage, long double weights) are still
+// selected for double arguments. the accuracy of each combination is
+// measured in nufd_tests/non_uniform_grid_tests/scalarTypes.cpp.
+
+// number of central points whose weights are applied together
+#define FDTYPED_BLOCK 64
+
+template <typename T, typename W>
+void fdcoef(unsigned int mord, unsigned int nord, T x0, const T *grid, T *coef, W *work) {
+  // same recursion as fdcoef with the arithmetic in W
+
+  // input:
+  // mord       = the order of the derivative
+  // nord       = order of accuracy n
+  // x0         = point at which to evaluate the coefficients
+  // grid[nord] = array containing the grid starting at the lowest bound
+  //              use during finite difference scheme
+  // work[mord * nord] = workspace
+
+  // output:
+  // coef[nord] = coefficients of the finite difference formula
+  W c1, c2, c3, c4, alpha;
+
+  work[0] = 1;
+  for (unsigned int mm(1); mm < mord; mm++)
+    work[mm * nord] = 0;
+
+  c1 = 1;
+  for (unsigned int nn(1); nn < nord; nn++) {
+    c2 = 1;
+    for (unsigned int nu(0); nu < nn; nu++) {
+      c3 = W(grid[nn]) - W(grid[nu]);
+      c2 = c2 * c3;
+
+      if (nu == nn - 1) {
+        alpha = W(grid[nn - 1]) - W(x0);
+        c4 = c1 / c2;
+        for (unsigned int mm(mord - 1); mm > 0; mm--)
+          work[mm * nord + nn] = c4 * (W(mm) * work[(mm - 1) * nord + nn - 1] - alpha * work[mm * nord + nn - 1]);
+        work[nn] = c4 * (-alpha * work[nn - 1]);
+      }
+
+      c4 = 1 / c3;
+      alpha = W(grid[nn]) - W(x0);
+      for (unsigned int mm(mord - 1); mm > 0; mm--)
+        work[mm * nord + nu] = c4 * (alpha * work[mm * nord + nu] - W(mm) * work[(mm - 1) * nord + nu]);
+      work[nu] = c4 * (alpha * work[nu]);
+    }
+    c1 = c2;
+  }
+
+  for (unsigned int nu(0); nu < nord; nu++)
+    coef[nu] = T(work[(mord - 1) * nord + nu]);
+}
+
+template <typename T, typename W = double>
+vector<T> fdcoef(unsigned int mord, unsigned int nord, T x0, typename vector<T>::const_iterator grid) {
+  vector<T> coef(nord, T(0));
+  vector<W> work(size_t(mord) * nord);
+  fdcoef<T, W>(mord, nord, x0, &grid[0], coef.data(), work.data());
+  return coef;
+}
+
+template <typename T, typename W = double>
+vector<T> fd(unsigned int m, unsigned int n, const vector<T> &grid, const vector<T> &u) {
+  // input:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // grid[ngrid] = array of independent values
+  // u[ngrid]    = function values at the grid points
+
+  // output:
+  // du[ngrid]   = derivative values at the grid points
+  size_t ngrid(grid.size());
+  vector<T> du(ngrid, T(0));
+  vector<T> coef(n, T(0));
+  vector<W> work(size_t(m) * n);
+
+  // weights of a block of central points stored by stencil
+  // node: wb[j * FDTYPED_BLOCK + b] for the point b of the block
+  vector<T> wb(size_t(n) * FDTYPED_BLOCK, T(0));
+
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+
+  // number of forward and backward points
+  // (one more backward point for even n)
+  size_t fb((n - 1) / 2);
+  size_t bb(n - 1 - fb);
+
+  auto points = [&](size_t begin, size_t end) {
+    for (size_t i(begin); i < end; i++) {
+      size_t start(fdstart(i, n, ngrid));
+      fdcoef<T, W>(m, n, grid[i], &grid[start], coef.data(), work.data());
+      for (unsigned int j(0); j < n; j++)
+        du[i] = du[i] + coef[j] * u[start + j];
+    }
+  };
+
+  // beginning of the grid (forward differences)
+  points(0, fb);
+
+  // end of grid (backward differences)
+  points(ngrid - bb, ngrid);
+
+  // central differences by blocks, the inner loop runs
+  // over contiguous points of the block (vectorized)
+  for (size_t i0(fb); i0 < ngrid - bb; i0 += FDTYPED_BLOCK) {
+    size_t nb(min(size_t(FDTYPED_BLOCK), ngrid - bb - i0));
+    for (size_t b(0); b < nb; b++) {
+      fdcoef<T, W>(m, n, grid[i0 + b], &grid[i0 + b - fb], coef.data(), work.data());
+      for (unsigned int j(0); j < n; j++)
+        wb[j * FDTYPED_BLOCK + b] = coef[j];
+    }
+
+    T *d(&du[i0]);
+    for (unsigned int j(0); j < n; j++) {
+      const T *w(&wb[j * FDTYPED_BLOCK]);
+      const T *uj(&u[i0 - fb + j]);
+      for (size_t b(0); b < nb; b++)
+        d[b] = d[b] + w[b] * uj[b];
+    }
+  }
+
+  return du;
+}
+
+#endif //_fdtyped_
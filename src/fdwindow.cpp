@@ -0,0 +1,99 @@
+#include "fdwindow.h"
+#include "fdstats.h"
+
+// the barycentric weights are computed from scratch after this many
+// updates so that rounding errors do not accumulate
+#define FDWINDOW_REFRESH 1024
+
+FdWindow::FdWindow(unsigned int m, unsigned int n)
+    : m(m), n(n), count(0), oldest(0), newest(0), updates(0), xw(n, 0.0), uw(n, 0.0), bw(n, 0.0), row(n, 0.0),
+      coef(n, 0.0) {
+  assert(m > 0 && m <= n);
+  FDSTATS_COUNT(allocations, 5);
+}
+
+void FdWindow::rebuild() {
+  // barycentric weights of the samples in the window, O(n^2)
+  for (size_t k(0); k < count; k++) {
+    size_t j((oldest + k) % n);
+    long double p(1.0);
+    for (size_t l(0); l < count; l++) {
+      size_t q((oldest + l) % n);
+      if (q != j)
+        p = p * (xw[j] - xw[q]);
+    }
+    bw[j] = 1.0 / p;
+  }
+  updates = 0;
+}
+
+double FdWindow::push(double x, double u) {
+  // retire the oldest sample
+  if (count == n) {
+    double xo(xw[oldest]);
+    oldest = (oldest + 1) % n;
+    count--;
+    for (size_t k(0); k < count; k++) {
+      size_t j((oldest + k) % n);
+      bw[j] = bw[j] * (xw[j] - xo);
+    }
+  }
+
+  // append the new sample
+  newest = (oldest + count) % n;
+  xw[newest] = x;
+  uw[newest] = u;
+  long double p(1.0);
+  for (size_t k(0); k < count; k++) {
+    size_t j((oldest + k) % n);
+    bw[j] = bw[j] / (xw[j] - x);
+    p = p * (x - xw[j]);
+  }
+  bw[newest] = 1.0 / p;
+  count++;
+
+  if (++updates >= FDWINDOW_REFRESH)
+    rebuild();
+
+  if (count < m)
+    return numeric_limits<double>::quiet_NaN();
+
+  // derivatives of the interpolating polynomial at the newest node,
+  // row[j] is the weight of sample j for the derivative of order k:
+  // row[j] = k / (x - x[j]) * (b[j] / b[newest] * row[newest] - row[j])
+  // and row[newest] = -sum(row[j], j != newest)
+  for (size_t j(0); j < n; j++)
+    row[j] = 0.0;
+  row[newest] = 1.0;
+  for (unsigned int k(1); k < m; k++) {
+    long double diag(row[newest]), sum(0.0);
+    for (size_t l(0); l < count; l++) {
+      size_t j((oldest + l) % n);
+      if (j == newest)
+        continue;
+      row[j] = k / (long double) (x - xw[j]) * (bw[j] / bw[newest] * diag - row[j]);
+      sum = sum + row[j];
+    }
+    row[newest] = -sum;
+  }
+
+  // load the weights from the oldest to the newest sample
+  FDSTATS_COUNT(points, 1);
+  double du(0.0);
+  coef.resize(count);
+  for (size_t l(0); l < count; l++) {
+    size_t j((oldest + l) % n);
+    coef[l] = double(row[j]);
+    du = du + coef[l] * uw[j];
+  }
+  return du;
+}
+
+vector<double> FdWindow::samples() const {
+  // abscissas of the window from the oldest to the newest sample
+  vector<double> x(count);
+  FDSTATS_COUNT(allocations, 1);
+  for (size_t l(0); l < count; l++)
+    x[l] = xw[(oldest + l) % n];
+  return x;
+}
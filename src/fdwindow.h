@@ -0,0 +1,48 @@
+#ifndef _fdwindow_
+#define _fdwindow_
+
+#include <limits>
+#include "nufd.h"
+
+// sliding window differentiator for real-time series
+//
+// every push() appends a sample, retires the oldest one when the window
+// of n points is full and returns the derivative at the new sample (the
+// one-sided stencil of fd() at the end of a grid). instead of running the
+// fdcoef recursion (O(m n^2)) for every sample, the barycentric weights
+// b[j] = 1 / prod(x[j] - x[k], k != j) of the window are updated in O(n)
+// when a node is added or retired, and the weights of the derivatives at
+// the newest node follow in O(m n) from the recurrence of
+// Schneider and Werner (math. comp., 47(175):285-299, 1986).
+class FdWindow {
+ public:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points in the window
+  FdWindow(unsigned int m, unsigned int n);
+
+  // appends the sample (x, u) and returns the derivative at x, computed
+  // with all the samples in the window (NaN while less than m samples)
+  double push(double x, double u);
+
+  // weights of the samples of the window for the last derivative
+  // (same order as samples())
+  const vector<double> &weights() const { return coef; }
+  vector<double> samples() const;
+
+  bool full() const { return count == n; }
+
+ private:
+  void rebuild();
+
+  unsigned int m, n;
+  size_t count, oldest, newest, updates;
+
+  // ring buffers of the window
+  vector<double> xw, uw;
+  vector<long double> bw;
+
+  vector<long double> row;
+  vector<double> coef;
+};
+
+#endif //_fdwindow_
@@ -1,6 +1,9 @@
 #include "nufd.h"
+#include "fdtable.h"
+#include "fdstats.h"
 
-vector<double> fdcoef(unsigned int mord, unsigned int nord, double x0, const vector<double>::const_iterator grid) {
+#ifndef NUFD_COMPENSATED
+static void fdweights(unsigned int mord, unsigned int nord, double x0, const double *grid, long double *weight) {
   // this routine implements simple recursions for calculating the weights
   // of finite difference formulas for any order of derivative and any order
   // of accuracy on one-dimensional grids with arbitrary spacing.
@@ -9,61 +12,416 @@ vector<double> fdcoef(unsigned int mord, unsigned int nord, double x0, const vec
   // generation of finite difference formulas on arbitrary spaced grids.
   // math. comp., 51(184):699-706, 1988.
 
+  // the weights of the stencil grid[0..nn] only depend on the weights of
+  // grid[0..nn-1], so they are updated in place (highest order first) and
+  // only the rolling state weight[mord][nord] of the last stencil is kept
+
   // input:
-  // mord       = the order of the derivative
+  // mord       = number of derivative orders (1=value, 2=1st diff, ...)
   // nord       = order of accuracy n
   // x0         = point at which to evaluate the coefficients
   // grid[nord] = array containing the grid starting at the lowest bound
   //              use during finite difference scheme
 
   // output:
-  // coef[nord] = coefficients of the finite difference formula
-  vector<double> coef(nord, 0.0);
+  // weight[mord * nord] = weight[mm * nord + nu] is the weight of grid[nu]
+  //                       for the derivative of order mm
 
   // local variables
-  int nmmin(min(nord, mord));
   double c1, c2, c3, c4, alpha;
+  FDSTATS_COUNT(fdcoef_calls, 1);
+  FDSTATS_TIMER(coef_time);
 
-  // more precision for weight calculations results
-  // in a smaller error on output coefficients
-  long double weight[nmmin + 1][nord][nord];
-  for (int i(0); i < nmmin + 1; i++)
-    for (int j(0); j < nord; j++)
-      for (int k(0); k < nord; k++)
-        weight[i][j][k] = 0.0;
+  // recursive algorithm implementation (more precision for weight
+  // calculations results in a smaller error on output coefficients)
+  weight[0] = 1.0;
+  for (int mm(1); mm < mord; mm++)
+    weight[mm * nord] = 0.0;
 
-  // recursive algorithm implementation
-  weight[0][0][0] = 1.0;
   c1 = 1.0;
   for (int nn(1); nn < nord; nn++) {
     c2 = 1.0;
     for (int nu(0); nu < nn; nu++) {
       c3 = grid[nn] - grid[nu];
       c2 = c2 * c3;
+
+      // new node nn, computed from the weights of node nn-1
+      // before they get updated below
+      if (nu == nn - 1) {
+        alpha = grid[nn - 1] - x0;
+        c4 = c1 / c2;
+        for (int mm(mord - 1); mm > 0; mm--)
+          weight[mm * nord + nn] =
+              c4 * (mm * weight[(mm - 1) * nord + nn - 1] - alpha * weight[mm * nord + nn - 1]);
+        weight[nn] = c4 * (-alpha * weight[nn - 1]);
+      }
+
       c4 = 1.0 / c3;
       alpha = grid[nn] - x0;
-      weight[0][nn][nu] = c4 * (alpha * weight[0][nn - 1][nu]);
-
-      for (int mm(1); mm < nmmin + 1; mm++)
-        weight[mm][nn][nu] = c4 * (alpha * weight[mm][nn - 1][nu] - mm * weight[mm - 1][nn - 1][nu]);
+      for (int mm(mord - 1); mm > 0; mm--)
+        weight[mm * nord + nu] = c4 * (alpha * weight[mm * nord + nu] - mm * weight[(mm - 1) * nord + nu]);
+      weight[nu] = c4 * (alpha * weight[nu]);
     }
-    alpha = grid[nn - 1] - x0;
-    weight[0][nn][nn] = c1 / c2 * (-alpha * weight[0][nn - 1][nn - 1]);
-    c4 = c1 / c2;
+    c1 = c2;
+  }
+}
+#endif
+
+// double-double arithmetic: a value is the unevaluated sum hi + lo of two
+// doubles with |lo| <= ulp(hi) / 2, the error-free transformations below
+// give about 106 bits of precision using only double operations
+// (dekker, numer. math., 18:224-242, 1971)
+struct fddd {
+  double hi, lo;
+};
+
+static inline fddd dd_fast_two_sum(double a, double b) {
+  // |a| >= |b|
+  fddd r;
+  r.hi = a + b;
+  r.lo = b - (r.hi - a);
+  return r;
+}
+
+static inline fddd dd_two_sum(double a, double b) {
+  fddd r;
+  r.hi = a + b;
+  double bb(r.hi - a);
+  r.lo = (a - (r.hi - bb)) + (b - bb);
+  return r;
+}
+
+static inline fddd dd_two_prod(double a, double b) {
+  fddd r;
+  r.hi = a * b;
+#ifdef FP_FAST_FMA
+  r.lo = fma(a, b, -r.hi);
+#else
+  // veltkamp splitting in 26 bits halves
+  const double split(134217729.0);
+  double t(split * a);
+  double ahi(t - (t - a)), alo(a - ahi);
+  t = split * b;
+  double bhi(t - (t - b)), blo(b - bhi);
+  r.lo = ((ahi * bhi - r.hi) + ahi * blo + alo * bhi) + alo * blo;
+#endif
+  return r;
+}
+
+static inline fddd dd_sub(fddd a, fddd b) {
+  fddd s(dd_two_sum(a.hi, -b.hi));
+  fddd t(dd_two_sum(a.lo, -b.lo));
+  s.lo = s.lo + t.hi;
+  s = dd_fast_two_sum(s.hi, s.lo);
+  s.lo = s.lo + t.lo;
+  return dd_fast_two_sum(s.hi, s.lo);
+}
+
+static inline fddd dd_mul(fddd a, fddd b) {
+  fddd p(dd_two_prod(a.hi, b.hi));
+  p.lo = p.lo + (a.hi * b.lo + a.lo * b.hi);
+  return dd_fast_two_sum(p.hi, p.lo);
+}
+
+static inline fddd dd_mul(fddd a, double b) {
+  fddd p(dd_two_prod(a.hi, b));
+  p.lo = p.lo + a.lo * b;
+  return dd_fast_two_sum(p.hi, p.lo);
+}
+
+static inline fddd dd_div(fddd a, fddd b) {
+  // long division, two quotient digits
+  double q1(a.hi / b.hi);
+  fddd r(dd_sub(a, dd_mul(b, q1)));
+  double q2(r.hi / b.hi);
+  return dd_fast_two_sum(q1, q2);
+}
+
+static void fdweights_dd(unsigned int mord, unsigned int nord, double x0, const double *grid, double *whi,
+                         double *wlo) {
+  // same recursion as fdweights in double-double arithmetic instead of
+  // long double (x87 on x86-64, no extra precision on other platforms)
+
+  // input:
+  // mord       = number of derivative orders (1=value, 2=1st diff, ...)
+  // nord       = order of accuracy n
+  // x0         = point at which to evaluate the coefficients
+  // grid[nord] = array containing the grid starting at the lowest bound
+  //              use during finite difference scheme
+
+  // output:
+  // whi[mord * nord] + wlo[mord * nord] = weights (see fdweights)
+
+  // local variables
+  fddd c1, c2, c3, c4, alpha, w;
+  const fddd one = {1.0, 0.0};
+  FDSTATS_COUNT(fdcoef_calls, 1);
+  FDSTATS_TIMER(coef_time);
+
+  whi[0] = 1.0;
+  wlo[0] = 0.0;
+  for (int mm(1); mm < mord; mm++) {
+    whi[mm * nord] = 0.0;
+    wlo[mm * nord] = 0.0;
+  }
+
+  c1 = one;
+  for (int nn(1); nn < nord; nn++) {
+    c2 = one;
+    for (int nu(0); nu < nn; nu++) {
+      c3 = dd_two_sum(grid[nn], -grid[nu]);
+      c2 = dd_mul(c2, c3);
 
-    for (int mm(1); mm < nmmin + 1; mm++)
-      weight[mm][nn][nn] = c4 * (mm * weight[mm - 1][nn - 1][nn - 1] - alpha * weight[mm][nn - 1][nn - 1]);
+      // new node nn, computed from the weights of node nn-1
+      // before they get updated below
+      if (nu == nn - 1) {
+        alpha = dd_two_sum(grid[nn - 1], -x0);
+        c4 = dd_div(c1, c2);
+        for (int mm(mord - 1); mm >= 0; mm--) {
+          fddd prev = {whi[mm * nord + nn - 1], wlo[mm * nord + nn - 1]};
+          if (mm > 0) {
+            fddd lower = {whi[(mm - 1) * nord + nn - 1], wlo[(mm - 1) * nord + nn - 1]};
+            w = dd_sub(dd_mul(lower, double(mm)), dd_mul(alpha, prev));
+          } else {
+            w = dd_mul(alpha, prev);
+            w.hi = -w.hi;
+            w.lo = -w.lo;
+          }
+          w = dd_mul(c4, w);
+          whi[mm * nord + nn] = w.hi;
+          wlo[mm * nord + nn] = w.lo;
+        }
+      }
 
+      c4 = dd_div(one, c3);
+      alpha = dd_two_sum(grid[nn], -x0);
+      for (int mm(mord - 1); mm >= 0; mm--) {
+        fddd cur = {whi[mm * nord + nu], wlo[mm * nord + nu]};
+        w = dd_mul(alpha, cur);
+        if (mm > 0) {
+          fddd lower = {whi[(mm - 1) * nord + nu], wlo[(mm - 1) * nord + nu]};
+          w = dd_sub(w, dd_mul(lower, double(mm)));
+        }
+        w = dd_mul(c4, w);
+        whi[mm * nord + nu] = w.hi;
+        wlo[mm * nord + nu] = w.lo;
+      }
+    }
     c1 = c2;
   }
+}
+
+static void fdweights_dd_round(unsigned int nord, const double *whi, const double *wlo, double *coef) {
+  // rounds the double-double weights of one derivative order to double,
+  // the weights below the precision of the recursion (relative to the
+  // largest weight) are exact zeros (e.g. central node of odd derivatives)
+  double wmax(0.0);
+  for (int nu(0); nu < nord; nu++)
+    wmax = max(wmax, fabs(whi[nu]));
+  for (int nu(0); nu < nord; nu++) {
+    coef[nu] = whi[nu] + wlo[nu];
+    if (fabs(coef[nu]) <= ldexp(wmax, -100))
+      coef[nu] = 0.0;
+  }
+}
+
+size_t fdcoef_dd_worksize(unsigned int mord, unsigned int nord) {
+  // number of double in the workspace of fdcoef_dd and fdcoef_all_dd
+  return 2 * size_t(mord) * nord;
+}
+
+void fdcoef_all_dd(unsigned int mord, unsigned int nord, double x0, const double *grid, double *coef,
+                   double *work) {
+  // fdcoef_all with the double-double recursion
+
+  // input:
+  // mord       = number of derivative orders (1=value, 2=1st diff, ...)
+  // nord       = order of accuracy n
+  // x0         = point at which to evaluate the coefficients
+  // grid[nord] = array containing the grid starting at the lowest bound
+  //              use during finite difference scheme
+  // work[fdcoef_dd_worksize(mord, nord)] = workspace
+
+  // output:
+  // coef[mord * nord] = coefficients of the finite difference formulas
+  //                     of all orders 0..mord-1
+  size_t size(size_t(mord) * nord);
+  fdweights_dd(mord, nord, x0, grid, work, work + size);
+  for (size_t k(0); k < mord; k++)
+    fdweights_dd_round(nord, &work[k * nord], &work[size + k * nord], &coef[k * nord]);
+}
+
+void fdcoef_dd(unsigned int mord, unsigned int nord, double x0, const double *grid, double *coef, double *work) {
+  // fdcoef with the double-double recursion
+
+  // input:
+  // mord       = the order of the derivative
+  // nord       = order of accuracy n
+  // x0         = point at which to evaluate the coefficients
+  // grid[nord] = array containing the grid starting at the lowest bound
+  //              use during finite difference scheme
+  // work[fdcoef_dd_worksize(mord, nord)] = workspace
+
+  // output:
+  // coef[nord] = coefficients of the finite difference formula
+  size_t size(size_t(mord) * nord);
+  fdweights_dd(mord, nord, x0, grid, work, work + size);
+  fdweights_dd_round(nord, &work[(mord - 1) * nord], &work[size + (mord - 1) * nord], coef);
+}
+
+size_t fdcoef_worksize(unsigned int mord, unsigned int nord) {
+  // number of long double in the workspace of fdcoef and fdcoef_all
+#ifdef NUFD_COMPENSATED
+  // room for the double-double workspace
+  return (fdcoef_dd_worksize(mord, nord) * sizeof(double) + sizeof(long double) - 1) / sizeof(long double);
+#else
+  return size_t(mord) * nord;
+#endif
+}
+
+void fdcoef_all(unsigned int mord, unsigned int nord, double x0, const double *grid, double *coef,
+                long double *work) {
+  // allocation free version of fdcoef_all
+
+  // input:
+  // mord       = number of derivative orders (1=value, 2=1st diff, ...)
+  // nord       = order of accuracy n
+  // x0         = point at which to evaluate the coefficients
+  // grid[nord] = array containing the grid starting at the lowest bound
+  //              use during finite difference scheme
+  // work[fdcoef_worksize(mord, nord)] = workspace
+
+  // output:
+  // coef[mord * nord] = coefficients of the finite difference formulas
+  //                     of all orders 0..mord-1, coef[k * nord + nu] being
+  //                     the weight of grid[nu] for the k-th derivative
+#ifdef NUFD_COMPENSATED
+  fdcoef_all_dd(mord, nord, x0, grid, coef, reinterpret_cast<double *>(work));
+#else
+  fdweights(mord, nord, x0, grid, work);
+  for (size_t k(0); k < size_t(mord) * nord; k++)
+    coef[k] = double(work[k]);
+#endif
+}
 
-  // load the coefficients
+void fdcoef(unsigned int mord, unsigned int nord, double x0, const double *grid, double *coef, long double *work) {
+  // allocation free version of fdcoef
+
+  // input:
+  // mord       = the order of the derivative
+  // nord       = order of accuracy n
+  // x0         = point at which to evaluate the coefficients
+  // grid[nord] = array containing the grid starting at the lowest bound
+  //              use during finite difference scheme
+  // work[fdcoef_worksize(mord, nord)] = workspace
+
+  // output:
+  // coef[nord] = coefficients of the finite difference formula
+#ifdef NUFD_COMPENSATED
+  fdcoef_dd(mord, nord, x0, grid, coef, reinterpret_cast<double *>(work));
+#else
+  fdweights(mord, nord, x0, grid, work);
   for (int nu(0); nu < nord; nu++)
-    coef[nu] = double(weight[mord - 1][nord - 1][nu]);
+    coef[nu] = double(work[(mord - 1) * nord + nu]);
+#endif
+}
+
+vector<double> fdcoef_all(unsigned int mord, unsigned int nord, double x0, const vector<double>::const_iterator grid) {
+  // this routine returns the coefficients of the finite difference
+  // formulas of all orders 0..mord-1 at x0, coef[k * nord + nu] being
+  // the weight of grid[nu] for the k-th derivative
+  vector<double> coef(mord * nord, 0.0);
+  vector<long double> work(fdcoef_worksize(mord, nord));
+  FDSTATS_COUNT(allocations, 2);
+  fdcoef_all(mord, nord, x0, &grid[0], coef.data(), work.data());
+  return coef;
+}
+
+vector<double> fdcoef(unsigned int mord, unsigned int nord, double x0, const vector<double>::const_iterator grid) {
+  // this routine computes the weights of finite difference formulas
+  // for any order of derivative and any order of accuracy on
+  // one-dimensional grids with arbitrary spacing (see fdweights)
+
+  // input:
+  // mord       = the order of the derivative
+  // nord       = order of accuracy n
+  // x0         = point at which to evaluate the coefficients
+  // grid[nord] = array containing the grid starting at the lowest bound
+  //              use during finite difference scheme
 
+  // output:
+  // coef[nord] = coefficients of the finite difference formula
+  vector<double> coef(nord, 0.0);
+  vector<long double> work(fdcoef_worksize(mord, nord));
+  FDSTATS_COUNT(allocations, 2);
+  fdcoef(mord, nord, x0, &grid[0], coef.data(), work.data());
   return coef;
 }
 
+static void fd_points(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                      vector<double> &du, size_t begin, size_t end) {
+  // this routine computes the order m derivatives du[begin..end-1]
+  // using n points, every point only depends on its own stencil
+  // so any partition of the grid gives the same values
+  size_t ngrid(grid.size());
+  vector<double> coef(n, 0.0);
+  vector<long double> work(fdcoef_worksize(m, n));
+  FDSTATS_COUNT(allocations, 2);
+
+  for (size_t i(begin); i < end; i++) {
+    size_t start(fdstart(i, n, ngrid));
+    fdcoef(m, n, grid[i], &grid[start], coef.data(), work.data());
+    for (int j(0); j < n; j++)
+      du[i] = du[i] + coef[j] * u[start + j];
+  }
+}
+
+static vector<double> fd_uniform_coef(unsigned int m, unsigned int n, double h) {
+  // this routine returns the weights coef[p * n + j] of node j of the
+  // stencil evaluated at node p on an uniform grid of spacing h, from
+  // the compile-time tables when available
+  vector<double> coef(n * n, 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  const double *table(fdtable_weights(m, n));
+  if (table) {
+    copy(table, table + n * n, coef.begin());
+  } else {
+    vector<double> nodes(n);
+    vector<long double> work(fdcoef_worksize(m, n));
+    for (int j(0); j < n; j++)
+      nodes[j] = j;
+    for (int p(0); p < n; p++)
+      fdcoef(m, n, p, nodes.data(), &coef[p * n], work.data());
+  }
+
+  // scale by h^(1-m)
+  double scale(1.0);
+  for (int k(1); k < m; k++)
+    scale = scale / h;
+  for (size_t k(0); k < coef.size(); k++)
+    coef[k] = coef[k] * scale;
+
+  return coef;
+}
+
+static void fd_uniform_points(unsigned int n, const vector<double> &coef, const vector<double> &u,
+                              vector<double> &du, size_t begin, size_t end) {
+  // this routine applies the uniform grid weights to du[begin..end-1],
+  // central points all use the weights of node (n-1)/2 (fixed weights
+  // convolution), forward and backward points the weights of their node
+  size_t ngrid(u.size());
+
+  for (size_t i(begin); i < end; i++) {
+    size_t start(fdstart(i, n, ngrid));
+    const double *w(&coef[(i - start) * n]);
+    const double *ui(&u[start]);
+    double sum(0.0);
+    for (int j(0); j < n; j++)
+      sum = sum + w[j] * ui[j];
+    du[i] = sum;
+  }
+}
+
 vector<double> fd(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u) {
   // this routine computes the order m derivatives
   // using n points on an arbitrary grid
@@ -76,42 +434,586 @@ vector<double> fd(unsigned int m, unsigned int n, const vector<double> &grid, co
 
   // output:
   // du[ngrid]   = first derivative values at the grid points
+  return fd(m, n, grid, u, 1);
+}
+
+vector<double> fd(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                  unsigned int nthreads) {
+  // this routine computes the order m derivatives
+  // using n points on an arbitrary grid with nthreads
+  // threads (0 = number of hardware threads), the values
+  // are identical for any number of threads
+
+  // input:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // grid[ngrid] = array of independent values
+  // u[ngrid]    = function values at the grid points
+  // nthreads    = number of threads (at most one per NUFD_THREAD_CHUNK points)
+
+  // output:
+  // du[ngrid]   = derivative values at the grid points
   size_t ngrid(grid.size());
   vector<double> du(ngrid, 0.0);
-  vector<double> coef(n, 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  FDSTATS_COUNT(points, ngrid);
 
   // validate the size of the grid and number of points
   // used in the finite difference scheme
   assert(n <= ngrid);
 
-  // use to point at the first element used
-  // in the finite diff scheme to pass to fdcoef
-  auto begin = grid.begin();
-  auto end = grid.end();
+  if (nthreads == 0)
+    nthreads = max(thread::hardware_concurrency(), 1u);
 
   // number of forward and backward points
-  int fb((n - 1) / 2);
+  // (one more backward point for even n)
+  size_t fb((n - 1) / 2);
+  size_t bb(n - 1 - fb);
+
+  // same stencil everywhere on uniform grids
+  vector<double> coef;
+  bool uniform(ngrid > 1 && fduniform(grid, NUFD_UNIFORM_RTOL));
+  if (uniform)
+    coef = fd_uniform_coef(m, n, (grid[ngrid - 1] - grid[0]) / double(ngrid - 1));
+
+  auto points = [&](size_t begin, size_t end) {
+    if (uniform)
+      fd_uniform_points(n, coef, u, du, begin, end);
+    else
+      fd_points(m, n, grid, u, du, begin, end);
+  };
 
   // beginning of the grid (forward differences)
-  for (int i(0); i < fb; i++) {
-    coef = fdcoef(m, n, grid[i], begin);
-    for (int j(0); j < n; j++)
-      du[i] = du[i] + coef[j] * u[j];
+  {
+    FDSTATS_TIMER(boundary_time);
+    points(0, fb);
   }
 
-  // middle of the grid (central differences)
-  for (int i(fb); i < ngrid - fb; i++) {
-    coef = fdcoef(m, n, grid[i], begin + i - fb);
-    for (int j(0); j < n; j++)
-      du[i] = du[i] + coef[j] * u[i - fb + j];
+  // middle of the grid (central differences) split
+  // in one contiguous chunk per thread, timed by each thread
+  {
+    auto interior = [&](size_t begin, size_t end) {
+      FDSTATS_TIMER(interior_time);
+      points(begin, end);
+    };
+    size_t nmid(ngrid - bb - fb);
+    nthreads = unsigned(max(size_t(1), min(size_t(nthreads), nmid / NUFD_THREAD_CHUNK)));
+    size_t chunk((nmid + nthreads - 1) / nthreads);
+    vector<thread> workers;
+    for (size_t begin(fb + chunk); begin < ngrid - bb; begin += chunk)
+      workers.push_back(thread(interior, begin, min(begin + chunk, ngrid - bb)));
+    interior(fb, min(fb + chunk, ngrid - bb));
+    for (size_t t(0); t < workers.size(); t++)
+      workers[t].join();
   }
 
   // end of grid (backward differences)
-  for (size_t i(ngrid - fb); i < ngrid; i++) {
-    coef = fdcoef(m, n, grid[i], end - n);
+  {
+    FDSTATS_TIMER(boundary_time);
+    points(ngrid - bb, ngrid);
+  }
+
+  return du;
+}
+
+void fd(unsigned int m, unsigned int n, size_t ngrid, const double *grid, size_t gstride, const double *u,
+        size_t ustride, double *du, size_t dstride, double *coef, long double *work) {
+  // allocation free version of fd for externally owned buffers, the
+  // values of point i being grid[i * gstride], u[i * ustride] and
+  // du[i * dstride] (e.g. columns of an array of records)
+
+  // input:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // ngrid       = number of grid points
+  // grid        = array of independent values
+  // u           = function values at the grid points
+  // coef[2 * n] = workspace (weights and nodes of a stencil)
+  // work[fdcoef_worksize(m, n)] = workspace
+
+  // output:
+  // du          = derivative values at the grid points
+  assert(n <= ngrid);
+  FDSTATS_COUNT(points, ngrid);
+
+  double *nodes(coef + n);
+  for (size_t i(0); i < ngrid; i++) {
+    size_t start(fdstart(i, n, ngrid));
+
+    // gather the nodes of the stencil when they are not contiguous
+    const double *x(&grid[start * gstride]);
+    if (gstride != 1) {
+      for (unsigned int j(0); j < n; j++)
+        nodes[j] = x[j * gstride];
+      x = nodes;
+    }
+
+    fdcoef(m, n, grid[i * gstride], x, coef, work);
+    const double *ui(&u[start * ustride]);
+    double sum(0.0);
+    for (unsigned int j(0); j < n; j++)
+      sum = sum + coef[j] * ui[j * ustride];
+    du[i * dstride] = sum;
+  }
+}
+
+bool fduniform(const vector<double> &grid, double rtol) {
+  // this routine checks if the grid is uniform: every node must be
+  // within rtol * h of grid[0] + i * h, h being the mean spacing
+  size_t ngrid(grid.size());
+  if (ngrid < 2)
+    return true;
+
+  double h((grid[ngrid - 1] - grid[0]) / double(ngrid - 1));
+  double tol(rtol * fabs(h));
+  for (size_t i(1); i < ngrid - 1; i++)
+    if (fabs(grid[i] - (grid[0] + double(i) * h)) > tol)
+      return false;
+
+  return true;
+}
+
+vector<double> fd_uniform(unsigned int m, unsigned int n, double h, const vector<double> &u) {
+  // this routine computes the order m derivatives using n points
+  // on an uniform grid, the weights are the same at every point
+  // (except the forward and backward stencils) and come from the
+  // compile-time tables when available
+
+  // input:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // h           = grid spacing
+  // u[ngrid]    = function values at the grid points
+
+  // output:
+  // du[ngrid]   = derivative values at the grid points
+  size_t ngrid(u.size());
+  vector<double> du(ngrid, 0.0);
+  FDSTATS_COUNT(allocations, 2);
+  FDSTATS_COUNT(points, ngrid);
+
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+
+  vector<double> coef = fd_uniform_coef(m, n, h);
+  fd_uniform_points(n, coef, u, du, 0, ngrid);
+
+  return du;
+}
+
+vector<vector<double> > fd_all(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u) {
+  // this routine computes all the derivatives of order 0..m-1
+  // using n points on an arbitrary grid, the weights of every
+  // order come from a single recursion per grid point
+
+  // input:
+  // m           = number of orders (1=value, 2=1st diff, ...)
+  // n           = number of points use in fd schemes
+  // grid[ngrid] = array of independent values
+  // u[ngrid]    = function values at the grid points
+
+  // output:
+  // du[m][ngrid] = du[k] contains the k-th derivative at the grid points
+  size_t ngrid(grid.size());
+  vector<vector<double> > du(m, vector<double>(ngrid, 0.0));
+  vector<double> coef(m * n, 0.0);
+  vector<long double> work(fdcoef_worksize(m, n));
+  FDSTATS_COUNT(allocations, m + 3);
+  FDSTATS_COUNT(points, size_t(m) * ngrid);
+
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+
+  for (size_t i(0); i < ngrid; i++) {
+    size_t start(fdstart(i, n, ngrid));
+    fdcoef_all(m, n, grid[i], &grid[start], coef.data(), work.data());
+
+    // each function value is loaded once for all orders
+    for (int j(0); j < n; j++) {
+      double uj(u[start + j]);
+      for (int k(0); k < m; k++)
+        du[k][i] = du[k][i] + coef[k * n + j] * uj;
+    }
+  }
+
+  return du;
+}
+
+vector<double> fd_batch(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                        size_t nfields) {
+  // this routine computes the order m derivatives of nfields
+  // fields sharing the same arbitrary grid using n points
+
+  // input:
+  // m                   1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n                   = number of points use in fd schemes
+  // grid[ngrid]         = array of independent values
+  // u[ngrid * nfields]  = function values interleaved by grid point,
+  //                       u[i * nfields + k] is field k at grid[i]
+
+  // output:
+  // du[ngrid * nfields] = derivative values with the same layout as u
+  size_t ngrid(grid.size());
+  vector<double> du(ngrid * nfields, 0.0);
+  vector<double> coef(n, 0.0);
+  vector<long double> work(fdcoef_worksize(m, n));
+  FDSTATS_COUNT(allocations, 3);
+  FDSTATS_COUNT(points, ngrid * nfields);
+
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+  assert(u.size() == ngrid * nfields);
+
+  for (size_t i(0); i < ngrid; i++) {
+    size_t start(fdstart(i, n, ngrid));
+    fdcoef(m, n, grid[i], &grid[start], coef.data(), work.data());
+
+    // the coefficients are loaded once per point and the
+    // contiguous inner loop over the fields is vectorized
+    double *dui(&du[i * nfields]);
+    for (int j(0); j < n; j++) {
+      const double cj(coef[j]);
+      const double *uj(&u[(start + j) * nfields]);
+      for (size_t k(0); k < nfields; k++)
+        dui[k] = dui[k] + cj * uj[k];
+    }
+  }
+
+  return du;
+}
+
+static void fd_eval_points(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                           const vector<double> &xq, unsigned int first, vector<vector<double> > &du) {
+  // this routine computes the derivatives of order first..m-1 at the
+  // query points xq, du[k - first][q] being the k-th derivative at xq[q]
+  size_t ngrid(grid.size()), nq(xq.size());
+  vector<double> coef(m * n, 0.0);
+  vector<long double> work(fdcoef_worksize(m, n));
+  FDSTATS_COUNT(allocations, 2);
+  FDSTATS_COUNT(points, nq * (m - first));
+
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+  assert(u.size() == ngrid);
+
+  // sorted queries walk along the grid, the others use a binary search
+  bool sorted(is_sorted(xq.begin(), xq.end()));
+  size_t k(0);
+
+  for (size_t q(0); q < nq; q++) {
+    // k = first grid node after xq[q]
+    if (sorted) {
+      while (k < ngrid && grid[k] <= xq[q])
+        k++;
+    } else {
+      k = size_t(upper_bound(grid.begin(), grid.end(), xq[q]) - grid.begin());
+    }
+
+    // stencil centered on the interval [grid[k-1], grid[k]]
+    size_t start(k < n / 2 ? 0 : min(k - n / 2, ngrid - n));
+    fdcoef_all(m, n, xq[q], &grid[start], coef.data(), work.data());
+
+    for (int o(first); o < m; o++) {
+      const double *w(&coef[o * n]);
+      double sum(0.0);
+      for (int j(0); j < n; j++)
+        sum = sum + w[j] * u[start + j];
+      du[o - first][q] = sum;
+    }
+  }
+}
+
+vector<double> fd_eval(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                       const vector<double> &xq) {
+  // this routine computes the order m derivatives using n points
+  // of an arbitrary grid at any points (m=1 is the interpolation)
+
+  // input:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // grid[ngrid] = array of independent values
+  // u[ngrid]    = function values at the grid points
+  // xq[nq]      = query points (sorted or not)
+
+  // output:
+  // du[nq]      = derivative values at the query points
+  vector<vector<double> > du(1, vector<double>(xq.size(), 0.0));
+  FDSTATS_COUNT(allocations, 2);
+  fd_eval_points(m, n, grid, u, xq, m - 1, du);
+  return du[0];
+}
+
+vector<vector<double> > fd_eval_all(unsigned int m, unsigned int n, const vector<double> &grid,
+                                    const vector<double> &u, const vector<double> &xq) {
+  // same as fd_eval for all the orders 0..m-1
+
+  // output:
+  // du[m][nq]   = du[k] contains the k-th derivative at the query points
+  vector<vector<double> > du(m, vector<double>(xq.size(), 0.0));
+  FDSTATS_COUNT(allocations, m + 1);
+  fd_eval_points(m, n, grid, u, xq, 0, du);
+  return du;
+}
+
+void fdcombine(unsigned int m, unsigned int n, const vector<vector<double> > &c, size_t i, const double *all,
+               double *coef) {
+  // this routine combines the weights of the orders 0..m-1 at grid point i
+  // (all[k * n + j] from fdcoef_all) in the stencil of the linear operator
+  // sum(c[k][i] * d^k / dx^k)
+  for (int j(0); j < n; j++)
+    coef[j] = 0.0;
+  for (int k(0); k < m; k++) {
+    const double ck(c[k][i]);
     for (int j(0); j < n; j++)
-      du[i] = du[i] + coef[j] * u[ngrid - n + j];
+      coef[j] = coef[j] + ck * all[k * n + j];
+  }
+}
+
+vector<double> fd_op(unsigned int n, const vector<double> &grid, const vector<vector<double> > &c,
+                     const vector<double> &u) {
+  // this routine applies the linear differential operator
+  // L u = sum(c[k][i] * d^k u / dx^k, k = 0..m-1) using n points
+  // on an arbitrary grid in a single pass over u
+
+  // input:
+  // n           = number of points use in fd schemes
+  // grid[ngrid] = array of independent values
+  // c[m][ngrid] = coefficient fields of the derivatives of order 0..m-1
+  // u[ngrid]    = function values at the grid points
+
+  // output:
+  // lu[ngrid]   = values of L u at the grid points
+  size_t ngrid(grid.size());
+  unsigned int m(c.size());
+  vector<double> lu(ngrid, 0.0);
+  vector<double> all(m * n, 0.0), coef(n, 0.0);
+  vector<long double> work(fdcoef_worksize(m, n));
+  FDSTATS_COUNT(allocations, 4);
+  FDSTATS_COUNT(points, ngrid);
+
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+  assert(m > 0);
+  for (unsigned int k(0); k < m; k++)
+    assert(c[k].size() == ngrid);
+
+  for (size_t i(0); i < ngrid; i++) {
+    size_t start(fdstart(i, n, ngrid));
+    fdcoef_all(m, n, grid[i], &grid[start], all.data(), work.data());
+    fdcombine(m, n, c, i, all.data(), coef.data());
+    for (int j(0); j < n; j++)
+      lu[i] = lu[i] + coef[j] * u[start + j];
+  }
+
+  return lu;
+}
+
+vector<double> fd_periodic(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                           double period) {
+  // this routine computes the order m derivatives using n points on an
+  // arbitrary grid of a periodic domain, every point uses a centered
+  // stencil that wraps around the ends of the arrays (the coordinates
+  // of the wrapped points are shifted by the period)
+
+  // input:
+  // m           1=value, 2=1st diff, 3=2nd diff, 4=3rd diff, ...
+  // n           = number of points use in fd schemes
+  // grid[ngrid] = array of independent values covering one period,
+  //               grid[ngrid - 1] < grid[0] + period
+  // u[ngrid]    = function values at the grid points
+  // period      = length of the domain
+
+  // output:
+  // du[ngrid]   = derivative values at the grid points
+  long ngrid(grid.size());
+  vector<double> du(ngrid, 0.0);
+  vector<double> coef(n, 0.0), x(n, 0.0);
+  vector<long double> work(fdcoef_worksize(m, n));
+  FDSTATS_COUNT(allocations, 4);
+  FDSTATS_COUNT(points, ngrid);
+
+  // validate the size of the grid and number of points
+  // used in the finite difference scheme
+  assert(n <= ngrid);
+
+  long fb((n - 1) / 2);
+  for (long i(0); i < ngrid; i++) {
+    // coordinates of the stencil
+    for (long j(0); j < n; j++) {
+      long k(i - fb + j);
+      if (k < 0)
+        x[j] = grid[k + ngrid] - period;
+      else if (k >= ngrid)
+        x[j] = grid[k - ngrid] + period;
+      else
+        x[j] = grid[k];
+    }
+
+    fdcoef(m, n, grid[i], x.data(), coef.data(), work.data());
+    for (long j(0); j < n; j++) {
+      long k(i - fb + j);
+      k = k < 0 ? k + ngrid : (k >= ngrid ? k - ngrid : k);
+      du[i] = du[i] + coef[j] * u[k];
+    }
   }
 
   return du;
 }
+
+size_t fdquad_worksize(unsigned int nord) {
+  // number of long double in the workspace of fdquad: the workspace of
+  // fdcoef_all followed by the weights of all the derivative orders
+  return fdcoef_worksize(nord, nord) +
+         (size_t(nord) * nord * sizeof(double) + sizeof(long double) - 1) / sizeof(long double);
+}
+
+void fdquad(unsigned int nord, double a, double b, const double *grid, double *coef, long double *work) {
+  // this routine computes the weights of the integral over [a, b] of the
+  // polynomial interpolating the nodes grid[nord]: the Taylor expansion of
+  // the polynomial around the middle c of the interval is integrated term
+  // by term with the weights of its derivatives at c given by fdcoef_all,
+  //   int_a^b p = sum_k p^(k)(c) * 2 (h/2)^(k+1) / (k+1)!  (k even, h = b - a)
+
+  // input:
+  // nord       = number of points of the quadrature (exact for the
+  //              polynomials of degree nord-1)
+  // a, b       = bounds of the integral
+  // grid[nord] = array containing the grid starting at the lowest bound
+  //              use during the quadrature
+  // work[fdquad_worksize(nord)] = workspace
+
+  // output:
+  // coef[nord] = weights of the quadrature
+  double *all(reinterpret_cast<double *>(work + fdcoef_worksize(nord, nord)));
+  double half(0.5 * (b - a));
+  fdcoef_all(nord, nord, a + half, grid, all, work);
+
+  for (unsigned int nu(0); nu < nord; nu++)
+    coef[nu] = 0.0;
+
+  // odd derivatives do not contribute on a symmetric interval
+  double f(2.0 * half);
+  for (unsigned int k(0); k < nord; k += 2) {
+    const double *w(&all[k * nord]);
+    for (unsigned int nu(0); nu < nord; nu++)
+      coef[nu] = coef[nu] + f * w[nu];
+    f = f * half * half / double((k + 2) * (k + 3));
+  }
+}
+
+static void fd_integral_points(unsigned int n, const vector<double> &grid, const vector<double> &u,
+                               vector<double> &iu, size_t begin, size_t end) {
+  // this routine computes the running integral of the intervals
+  // [grid[i], grid[i+1]] for i = begin..end-1 starting from zero
+  size_t ngrid(grid.size());
+  vector<double> coef(n, 0.0);
+  vector<long double> work(fdquad_worksize(n));
+  FDSTATS_COUNT(allocations, 2);
+  FDSTATS_TIMER(interior_time);
+
+  double sum(0.0);
+  for (size_t i(begin); i < end; i++) {
+    // stencil centered on the interval [grid[i], grid[i+1]]
+    size_t k(i + 1);
+    size_t start(k < n / 2 ? 0 : min(k - n / 2, ngrid - n));
+    fdquad(n, grid[i], grid[k], &grid[start], coef.data(), work.data());
+
+    double s(0.0);
+    for (unsigned int j(0); j < n; j++)
+      s = s + coef[j] * u[start + j];
+    sum = sum + s;
+    iu[k] = sum;
+  }
+}
+
+vector<double> fd_integral(unsigned int n, const vector<double> &grid, const vector<double> &u) {
+  // this routine computes the running integral of u from grid[0]
+  // using n points quadratures on an arbitrary grid in one pass
+
+  // input:
+  // n           = number of points use in the quadratures (n=2 is the
+  //               trapezoidal rule, the error of an interval is O(h^(n+1)))
+  // grid[ngrid] = array of independent values
+  // u[ngrid]    = function values at the grid points
+
+  // output:
+  // iu[ngrid]   = integral of u from grid[0] to the grid points
+  return fd_integral(n, grid, u, 1);
+}
+
+vector<double> fd_integral(unsigned int n, const vector<double> &grid, const vector<double> &u,
+                           unsigned int nthreads) {
+  // this routine computes the running integral of u from grid[0]
+  // using n points quadratures on an arbitrary grid with nthreads
+  // threads (0 = number of hardware threads): each thread integrates
+  // a contiguous chunk of intervals from zero, then the totals of the
+  // previous chunks are added to every chunk (parallel prefix sum).
+  // the values depend on the number of threads up to rounding
+
+  // input:
+  // n           = number of points use in the quadratures
+  // grid[ngrid] = array of independent values
+  // u[ngrid]    = function values at the grid points
+  // nthreads    = number of threads
+
+  // output:
+  // iu[ngrid]   = integral of u from grid[0] to the grid points
+  size_t ngrid(grid.size());
+  vector<double> iu(ngrid, 0.0);
+  FDSTATS_COUNT(allocations, 1);
+  FDSTATS_COUNT(points, ngrid);
+
+  // validate the size of the grid and number of points
+  // used in the quadratures
+  assert(n >= 2 && n <= ngrid);
+  assert(u.size() == ngrid);
+
+  if (nthreads == 0)
+    nthreads = max(thread::hardware_concurrency(), 1u);
+
+  // intervals [begin, end) of every chunk
+  size_t nint(ngrid - 1);
+  size_t chunk((nint + nthreads - 1) / nthreads);
+  vector<size_t> bounds;
+  FDSTATS_COUNT(allocations, 1);
+  for (size_t begin(0); begin < nint; begin += chunk)
+    bounds.push_back(begin);
+  bounds.push_back(nint);
+
+  // integrals of every chunk starting from zero (timed by each thread)
+  {
+    auto points = [&](size_t begin, size_t end) { fd_integral_points(n, grid, u, iu, begin, end); };
+    vector<thread> workers;
+    for (size_t c(1); c + 1 < bounds.size(); c++)
+      workers.push_back(thread(points, bounds[c], bounds[c + 1]));
+    points(bounds[0], bounds[1]);
+    for (size_t t(0); t < workers.size(); t++)
+      workers[t].join();
+  }
+
+  // totals of the previous chunks, added in parallel to
+  // the intervals of the chunks (except the first one)
+  if (bounds.size() > 2) {
+    vector<double> offset(bounds.size() - 1, 0.0);
+    FDSTATS_COUNT(allocations, 1);
+    for (size_t c(1); c + 1 < bounds.size(); c++)
+      offset[c] = offset[c - 1] + iu[bounds[c]];
+
+    auto add = [&](size_t c) {
+      for (size_t k(bounds[c] + 1); k <= bounds[c + 1]; k++)
+        iu[k] = iu[k] + offset[c];
+    };
+    vector<thread> workers;
+    for (size_t c(1); c + 1 < bounds.size(); c++)
+      workers.push_back(thread(add, c));
+    for (size_t t(0); t < workers.size(); t++)
+      workers[t].join();
+  }
+
+  return iu;
+}
@@ -7,11 +7,69 @@
 #include <iomanip>
 #include <random>
 #include <chrono>
+#include <thread>
+#include <cmath>
 #include <assert.h>
 
 using namespace std;
 
+size_t fdcoef_worksize(unsigned int mord, unsigned int nord);
+void fdcoef_all(unsigned int mord, unsigned int nord, double x0, const double *grid, double *coef,
+                long double *work);
+void fdcoef(unsigned int mord, unsigned int nord, double x0, const double *grid, double *coef, long double *work);
+size_t fdcoef_dd_worksize(unsigned int mord, unsigned int nord);
+void fdcoef_all_dd(unsigned int mord, unsigned int nord, double x0, const double *grid, double *coef,
+                   double *work);
+void fdcoef_dd(unsigned int mord, unsigned int nord, double x0, const double *grid, double *coef, double *work);
+vector<double> fdcoef_all(unsigned int mord, unsigned int nord, double x0, const vector<double>::const_iterator grid);
 vector<double> fdcoef(unsigned int mord, unsigned int nord, double x0, const vector<double>::const_iterator grid);
 vector<double> fd(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u);
+vector<double> fd(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                  unsigned int nthreads);
+void fd(unsigned int m, unsigned int n, size_t ngrid, const double *grid, size_t gstride, const double *u,
+        size_t ustride, double *du, size_t dstride, double *coef, long double *work);
+vector<double> fd_uniform(unsigned int m, unsigned int n, double h, const vector<double> &u);
+vector<vector<double> > fd_all(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u);
+vector<double> fd_eval(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                       const vector<double> &xq);
+vector<vector<double> > fd_eval_all(unsigned int m, unsigned int n, const vector<double> &grid,
+                                    const vector<double> &u, const vector<double> &xq);
+void fdcombine(unsigned int m, unsigned int n, const vector<vector<double> > &c, size_t i, const double *all,
+               double *coef);
+vector<double> fd_op(unsigned int n, const vector<double> &grid, const vector<vector<double> > &c,
+                     const vector<double> &u);
+vector<double> fd_periodic(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                           double period);
+size_t fdquad_worksize(unsigned int nord);
+void fdquad(unsigned int nord, double a, double b, const double *grid, double *coef, long double *work);
+vector<double> fd_integral(unsigned int n, const vector<double> &grid, const vector<double> &u);
+vector<double> fd_integral(unsigned int n, const vector<double> &grid, const vector<double> &u,
+                           unsigned int nthreads);
+vector<double> fd_batch(unsigned int m, unsigned int n, const vector<double> &grid, const vector<double> &u,
+                        size_t nfields);
+
+// fd() uses the fixed weights of fd_uniform() when all the nodes are
+// within NUFD_UNIFORM_RTOL times the spacing of a uniform grid
+#ifndef NUFD_UNIFORM_RTOL
+#define NUFD_UNIFORM_RTOL 1e-10
+#endif
+
+// the threaded fd() gives each thread at least NUFD_THREAD_CHUNK central
+// points, smaller grids are differentiated by fewer threads (or serially)
+#ifndef NUFD_THREAD_CHUNK
+#define NUFD_THREAD_CHUNK 4096
+#endif
+
+bool fduniform(const vector<double> &grid, double rtol);
+
+// first grid index of the n points stencil used at grid point i:
+// forward stencils at the beginning, central stencils in the middle
+// and backward stencils at the end of a grid of ngrid points
+inline size_t fdstart(size_t i, unsigned int n, size_t ngrid) {
+  size_t fb((n - 1) / 2);
+  if (i < fb)
+    return 0;
+  return min(i - fb, ngrid - n);
+}
 
 #endif //_nufd_
\ No newline at end of file